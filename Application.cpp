@@ -5,6 +5,7 @@
  **********************************/
 
 #include "Application.h"
+#include <sys/resource.h>
 
 void handler(int sig) {
 	void *array[10];
@@ -47,11 +48,18 @@ int main(int argc, char *argv[]) {
 Application::Application(char *infile) {
 	int i;
 	par = new Params();
-	srand (time(NULL));
 	par->setparams(infile);
+	failRng.seed(par->SEED, RNG_STREAM_FAIL);
+	nextEvent = 0;
+	healedAt = -1;
 	log = new Log(par);
 	en = new EmulNet(par);
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
+	pool = new WorkerPool(max(par->THREADS, 1));
+	sinks.resize(par->EN_GPSZ);
+	wokenAt.resize(par->EN_GPSZ, -1);
+	metrics = new Metrics();
+	metrics->init(par->EN_GPSZ);
 
 	/*
 	 * Init all nodes
@@ -63,9 +71,13 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode, metrics);
+		if( Log::enabled<LOG_DEBUG>() ) {
+			log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+		}
 		delete addressOfMemberNode;
+		// First run of the node: its introduction
+		timers.push((int)(par->STEP_RATE*i), i);
 	}
 }
 
@@ -73,8 +85,10 @@ Application::Application(char *infile) {
  * Destructor
  */
 Application::~Application() {
+	delete pool;
 	delete log;
 	delete en;
+	delete metrics;
 	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 		delete mp1[i];
 	}
@@ -93,18 +107,48 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	struct rusage usage;
 
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
+	// As time runs along, from one tick in which something is due to the
+	// next
+	for( par->globaltime = 0; par->globaltime < par->RUN_LENGTH; par->globaltime = nextTick() ) {
+		// Let the network recycle its per-tick memory
+		en->ENtick();
+		// Wake the nodes with a timer or a message due
+		woken.clear();
+		en->ENdeliver(woken);
+		for( i = 0; i < (int)woken.size(); i++ ) {
+			woken[i]--;
+		}
+		while( !timers.empty() && timers.nextTime() <= par->getcurrtime() ) {
+			woken.push_back(timers.pop());
+		}
 		// Run the membership protocol
 		mp1Run();
+		metrics->tick(par->getcurrtime());
 		// Fail some nodes
 		fail();
+		// Report how long the group took to mend after a heal
+		if( healedAt >= 0 && converged() ) {
+			if( Log::enabled<LOG_NETWORK>() ) {
+				log->LOG(&mp1[0]->getMemberNode()->addr, "Group reconverged %d ticks after heal at time=%d", par->getcurrtime() - healedAt, healedAt);
+			}
+			cout<<"Group reconverged "<<par->getcurrtime() - healedAt<<" ticks after heal at time="<<healedAt<<endl;
+			metrics->reconvergedAfter(par->getcurrtime() - healedAt);
+			healedAt = -1;
+		}
+		watchFailures();
 	}
+	par->globaltime = par->RUN_LENGTH;
+
+	getrusage(RUSAGE_SELF, &usage);
+	metrics->runCost(chrono::duration<double>(chrono::steady_clock::now() - start).count(), usage.ru_maxrss);
+	report();
 
 	// Clean up
 	en->ENcleanup();
+	log->sync();
 
 	for(i=0;i<=par->EN_GPSZ-1;i++) {
 		 mp1[i]->finishUpThisNode();
@@ -119,10 +163,22 @@ int Application::run()
  * DESCRIPTION:	This function performs all the membership protocol functionalities
  */
 void Application::mp1Run() {
-	int i;
+	int i, k;
+
+	// The nodes woken for this tick, once each, last one first
+	k = 0;
+	for( i = 0; i < (int)woken.size(); i++ ) {
+		if( woken[i] >= 0 && woken[i] < par->EN_GPSZ && wokenAt[woken[i]] != par->getcurrtime() ) {
+			wokenAt[woken[i]] = par->getcurrtime();
+			woken[k++] = woken[i];
+		}
+	}
+	woken.resize(k);
+	sort(woken.begin(), woken.end(), greater<int>());
 
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	// For all the nodes woken up
+	pool->run(woken.size(), [this](int k) {
+		int i = woken[k];
 
 		/*
 		 * Receive messages from the network and queue them in the membership protocol queue
@@ -132,73 +188,258 @@ void Application::mp1Run() {
 			mp1[i]->recvLoop();
 		}
 
-	}
+	});
 
-	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+	// For all the nodes woken up
+	pool->run(woken.size(), [this](int k) {
+		runNode(woken[k]);
+	});
 
-		/*
-		 * Introduce nodes into the distributed system
-		 */
+	// Replay the output of the nodes in the order in which a single thread
+	// would have produced it, and set the next timer of the live ones
+	for( k = 0; k < (int)woken.size(); k++ ) {
+		i = woken[k];
+		log->flush(&sinks[i]);
 		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
-			// introduce the ith node into the system at time STEPRATE*i
-			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
 			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
 			nodeCount += i;
 		}
-
-		/*
-		 * Handle all the messages in your queue and send heartbeats
-		 */
-		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// handle messages and send heartbeats
-			mp1[i]->nodeLoop();
-			#ifdef DEBUGLOG
-			if( (i == 0) && (par->globaltime % 500 == 0) ) {
-				log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
-			}
-			#endif
+		if( par->getcurrtime() >= (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+			wake(i);
 		}
+	}
+	en->ENflush();
+}
+
+/**
+ * FUNCTION NAME: wake
+ *
+ * DESCRIPTION: Run the ith node again next tick, for its heartbeat and
+ * 				TFAIL / TREMOVE checks
+ */
+void Application::wake(int i) {
+	timers.push(par->getcurrtime() + 1, i);
+}
+
+/**
+ * FUNCTION NAME: nextTick
+ *
+ * DESCRIPTION: The next tick in which a node has to run, a message arrives
+ * 				or an event of the schedule is due; RUN_LENGTH if none
+ */
+int Application::nextTick() {
+	long next = par->RUN_LENGTH;
+	if( !timers.empty() ) {
+		next = min(next, timers.nextTime());
+	}
+	if( en->ENnextTick() >= 0 ) {
+		next = min(next, en->ENnextTick());
+	}
+	if( nextEvent < par->events.size() ) {
+		next = min(next, (long)par->events[nextEvent].time);
+	}
+	return (int)max(next, (long)par->getcurrtime() + 1);
+}
+
+/**
+ * FUNCTION NAME: runNode
+ *
+ * DESCRIPTION: Start the ith node or run its protocol for this tick. May run
+ * 				on any thread of the pool: the node only touches its own state
+ * 				and outbox, and its log lines are kept in sinks[i].
+ */
+void Application::runNode(int i) {
+	log->capture(&sinks[i]);
+
+	/*
+	 * Introduce nodes into the distributed system
+	 */
+	if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+		// introduce the ith node into the system at time STEPRATE*i
+		mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+	}
 
+	/*
+	 * Handle all the messages in your queue and send heartbeats
+	 */
+	else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+		// handle messages and send heartbeats
+		mp1[i]->nodeLoop();
+		if( Log::enabled<LOG_DEBUG>() && (i == 0) && (par->globaltime % 500 == 0) ) {
+			log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+		}
 	}
+
+	log->capture(NULL);
 }
 
 /**
  * FUNCTION NAME: fail
  *
- * DESCRIPTION: This function controls the failure of nodes
+ * DESCRIPTION: This function controls the failure of nodes: it applies the
+ * 				events of the schedule in Params that are due at the end of
+ * 				this tick
  *
  * Note: this is used only by MP1
  */
 void Application::fail() {
-	int i, removed;
+	int i;
+
+	while( nextEvent < par->events.size() && par->events[nextEvent].time == par->getcurrtime() ) {
+		SimEvent &e = par->events[nextEvent++];
+		int first = e.first, last = e.last;
 
-	// fail half the members at time t=400
-	if( par->DROP_MSG && par->getcurrtime() == 50 ) {
-		par->dropmsg = 1;
+		if( e.type == EVENT_FAIL && first < 0 ) {
+			first = failRng.below(par->EN_GPSZ - e.count + 1);
+			last = first + e.count - 1;
+		}
+
+		switch( e.type ) {
+		case EVENT_FAIL:
+			for( i = first; i <= last; i++ ) {
+				// The original test cases log a single failure and a group
+				// failure in slightly different words
+				if( Log::enabled<LOG_MEMBERSHIP>() ) {
+					log->LOG(&mp1[i]->getMemberNode()->addr, first == last ? "Node failed at time=%d" : "Node failed at time = %d", par->getcurrtime());
+				}
+				if( !mp1[i]->getMemberNode()->bFailed ) {
+					metrics->nodeFailed(*(int *)mp1[i]->getMemberNode()->addr.addr, par->getcurrtime(), mp1[i]->getMemberNode()->inGroup);
+				}
+				if( mp1[i]->getMemberNode()->inGroup && !mp1[i]->getMemberNode()->bFailed ) {
+					watched.push_back(i);
+				}
+				mp1[i]->getMemberNode()->bFailed = true;
+				en->ENdown(&mp1[i]->getMemberNode()->addr, true);
+			}
+			break;
+		case EVENT_RECOVER:
+			for( i = first; i <= last; i++ ) {
+				// Only nodes that were started and then failed come back
+				if( !mp1[i]->getMemberNode()->bFailed || !mp1[i]->getMemberNode()->inited ) {
+					continue;
+				}
+				if( Log::enabled<LOG_MEMBERSHIP>() ) {
+					log->LOG(&mp1[i]->getMemberNode()->addr, "Node recovered at time=%d", par->getcurrtime());
+				}
+				metrics->nodeRecovered(*(int *)mp1[i]->getMemberNode()->addr.addr);
+				en->ENdown(&mp1[i]->getMemberNode()->addr, false);
+				mp1[i]->finishUpThisNode();
+				mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+				wake(i);
+			}
+			break;
+		case EVENT_PARTITION:
+			// Every partition event opens a new side, numbered as the fault
+			for( i = first; i <= last; i++ ) {
+				en->ENpartition(&mp1[i]->getMemberNode()->addr, e.fault);
+			}
+			break;
+		case EVENT_CUT:
+			en->ENcut(*(int *)mp1[first]->getMemberNode()->addr.addr, *(int *)mp1[last]->getMemberNode()->addr.addr,
+					*(int *)mp1[e.toFirst]->getMemberNode()->addr.addr, *(int *)mp1[e.toLast]->getMemberNode()->addr.addr, e.prob, e.fault);
+			break;
+		case EVENT_HEAL:
+			en->ENheal(e.fault);
+			healedAt = par->getcurrtime();
+			metrics->healed();
+			break;
+		case EVENT_DROP:
+			par->MSG_DROP_PROB = e.prob;
+			par->dropmsg = e.prob > 0;
+			break;
+		}
 	}
+}
+
+/**
+ * FUNCTION NAME: converged
+ *
+ * DESCRIPTION: Whether every started live node is in the group and has all
+ * 				the other ones in its membership list
+ */
+bool Application::converged() {
+	vector<int> live;
+	int i, j;
 
-	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
-		#ifdef DEBUGLOG
-		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-		#endif
-		mp1[removed]->getMemberNode()->bFailed = true;
+	for( i = 0; i < par->EN_GPSZ; i++ ) {
+		Member *node = mp1[i]->getMemberNode();
+		if( node->inited && !node->bFailed ) {
+			if( !node->inGroup ) {
+				return false;
+			}
+			live.push_back(i);
+		}
 	}
-	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
-		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
-			#ifdef DEBUGLOG
-			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
-			#endif
-			mp1[i]->getMemberNode()->bFailed = true;
+	for( i = 0; i < (int)live.size(); i++ ) {
+		for( j = 0; j < (int)live.size(); j++ ) {
+			if( i != j && !mp1[live[i]]->hasMember(&mp1[live[j]]->getMemberNode()->addr) ) {
+				return false;
+			}
 		}
 	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: watchFailures
+ *
+ * DESCRIPTION: Tell the metrics when the last live node stopped listing
+ * 				each failed node. Works the same for every PROTOCOL, so their
+ * 				detection times can be compared.
+ */
+void Application::watchFailures() {
+	int k, j;
 
-	if( par->DROP_MSG && par->getcurrtime() == 300) {
-		par->dropmsg=0;
+	for( k = 0; k < (int)watched.size(); k++ ) {
+		int f = watched[k];
+		int live = 0, listing = 0;
+		if( !mp1[f]->getMemberNode()->bFailed ) {
+			// Recovered before everyone noticed
+			watched.erase(watched.begin() + k--);
+			continue;
+		}
+		for( j = 0; j < par->EN_GPSZ; j++ ) {
+			Member *node = mp1[j]->getMemberNode();
+			if( node->inited && node->inGroup && !node->bFailed ) {
+				live++;
+				listing += mp1[j]->hasMember(&mp1[f]->getMemberNode()->addr);
+			}
+		}
+		if( listing == 0 ) {
+			metrics->failureCleared(*(int *)mp1[f]->getMemberNode()->addr.addr, par->getcurrtime());
+			watched.erase(watched.begin() + k--);
+		}
 	}
+}
 
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Print the message load of the run and the detection times,
+ * 				to compare the protocols, and dump all the metrics
+ */
+void Application::report() {
+	MsgStats &stats = en->ENstats();
+	long msgs = 0, bytes = 0, busiest = 0;
+	int i;
+
+	for( i = 1; i <= par->EN_GPSZ; i++ ) {
+		msgs += stats.getSentTotal(i);
+		bytes += stats.getSentBytes(i);
+		busiest = max(busiest, stats.getSentTotal(i));
+	}
+	double nodeTicks = (double)par->EN_GPSZ * max(par->RUN_LENGTH, 1);
+	const char *protocol = par->PROTOCOL == PROTOCOL_SWIM ? (par->GOSSIP_MODE == GOSSIP_BUFFER ? "swim (buffer gossip)" : "swim") :
+			par->GOSSIP_ADAPTIVE ? "gossip (adaptive)" : "gossip";
+	printf("Protocol %s: %.2f msgs (busiest node %.2f) %.1f bytes sent per node per tick\n", protocol, msgs / nodeTicks,
+			(double)busiest / max(par->RUN_LENGTH, 1), bytes / nodeTicks);
+	double firstMean, lastMean;
+	int detected = metrics->getDetected(&firstMean, &lastMean);
+	printf("%d of %d failures detected, after %.1f ticks by the first node and %.1f by the last on average\n",
+			detected, detected + (int)watched.size(), firstMean, lastMean);
+	if( !metrics->dump(en, par->RUN_LENGTH, protocol) ) {
+		fprintf(stderr, "Cannot write %s and %s\n", METRICS_JSON, METRICS_CSV);
+	}
 }
 
 /**
@@ -14,6 +14,10 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "WorkerPool.h"
+#include "Random.h"
+#include "EventQueue.h"
+#include "Metrics.h"
 
 /**
  * global variables
@@ -24,7 +28,6 @@ int nodeCount = 0;
  * Macros
  */
 #define ARGS_COUNT 2
-#define TOTAL_RUNNING_TIME 700
 
 /**
  * CLASS NAME: Application
@@ -40,13 +43,38 @@ private:
     Log *log;
 	MP1Node **mp1;
 	Params *par;
+	// Runs the nodes of a tick, THREADS wide
+	WorkerPool *pool;
+	// Log lines of each node during a tick
+	vector<LogSink> sinks;
+	// Picks the nodes to fail
+	Random failRng;
+	// Next entry of par->events to apply
+	unsigned int nextEvent;
+	// Tick of the last heal, -1 once the group has reconverged
+	int healedAt;
+	// Failed nodes (by index) some live node still lists
+	vector<int> watched;
+	// Join, detection and load figures of the run
+	Metrics *metrics;
+	// Ticks at which nodes (by index) have to run
+	EventQueue<int> timers;
+	// Nodes running in the current tick, and the tick each node last ran
+	vector<int> woken;
+	vector<int> wokenAt;
 public:
 	Application(char *);
 	virtual ~Application();
 	Address getjoinaddr();
 	int run();
 	void mp1Run();
+	void runNode(int i);
+	void wake(int i);
+	int nextTick();
 	void fail();
+	bool converged();
+	void watchFailures();
+	void report();
 };
 
 #endif /* _APPLICATION_H__ */
@@ -12,51 +12,38 @@
 EmulNet::EmulNet(Params *p)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
+	int i;
 	par = p;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
+	latency = max(1L, (long)(par->LATENCY * SUBTICKS));
+	if ( par->BUFF_SIZE > 0 ) {
+		buffsize = par->BUFF_SIZE;
 	}
-	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
-}
-
-/**
- * Copy constructor
- */
-EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
+	else {
+		// A message counts from the ENflush that sends it to the one after
+		// its receive
+		long ticks = 2 + (long)ceil(par->LATENCY + par->LINK_SPREAD + par->JITTER) + (par->REORDER > 0) + par->QUEUE_LIMIT;
+		buffsize = max((long)ENBUFFSIZE, (long)par->EN_GPSZ * ENBUFFPERNODE * ticks);
 	}
-	this->emulnet = anotherEmulNet.emulnet;
-}
-
-/**
- * Assignment operator overloading
- */
-EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
+	bool bounded = par->JITTER_DIST == JITTER_UNIFORM && par->BANDWIDTH == 0 && par->REORDER == 0;
+	if ( par->ARENA_RESET && (!bounded || par->LATENCY + par->LINK_SPREAD + par->JITTER > 1) ) {
+		// Tick mode frees everything within a tick boundary
+		fprintf(stderr, "EmulNet: ARENA_RESET needs messages to arrive within one tick, ignoring it\n");
+		par->ARENA_RESET = 0;
 	}
-	this->emulnet = anotherEmulNet.emulnet;
-	return *this;
+	delaySum = 0;
+	delayMax = 0;
+	delayCount = 0;
+	slab.setMode(par->ARENA_RESET ? SLAB_TICK : SLAB_FREELIST);
+	rng.seed(par->SEED, RNG_STREAM_NET);
+	drained = 0;
+	stats.init(par->EN_GPSZ, par->RUN_LENGTH);
+	for ( i = 0; i < DROP_REASONS; i++ ) {
+		dropped[i] = 0;
+	}
+	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
 /**
@@ -73,50 +60,181 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
 	// Initialize data structures for this member
 	*(int *)(myaddr->addr) = emulnet.nextid++;
     *(short *)(&myaddr->addr[4]) = 0;
+	// Open the mailbox and outbox for this node, so that sends and
+	// receives never need to grow them
+	emulnet.getMailbox(*(int *)(myaddr->addr));
+	emulnet.getOutbox(*(int *)(myaddr->addr));
+	stats.addNode(*(int *)(myaddr->addr));
+	ENpartition(myaddr, 0);
 	return myaddr;
 }
 
 /**
  * FUNCTION NAME: ENsend
  *
- * DESCRIPTION: EmulNet send function
+ * DESCRIPTION: EmulNet send function. The message takes its own reference
+ * 				on buf, so the caller keeps (and must release) its reference.
+ * 				It waits in the outbox of the sender until ENflush, so nodes
+ * 				may send concurrently as long as each sends only as itself.
  *
  * RETURNS:
  * size
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, MsgBuf *buf) {
 	en_msg *em;
-	static char temp[2048];
-	int sendmsg = rand() % 100;
+	int src = *(int *)(myaddr->addr);
+	vector<en_msg *> *outbox = emulnet.getOutbox(src);
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
-		return 0;
+	if ( outbox->empty() ) {
+		lock_guard<mutex> guard(sendersLock);
+		senders.push_back(src);
 	}
 
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
-	em->size = size;
+	em = (en_msg *)slab.alloc(sizeof(en_msg));
+	em->size = buf->size;
+	em->born = par->getcurrtime();
+	em->arrive = 0;
 
 	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
 	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
-	memcpy(em + 1, data, size);
+	em->buf = buf->retain();
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
+	outbox->push_back(em);
 
-	int src = *(int *)(myaddr->addr);
+	return em->size;
+}
+
+/**
+ * FUNCTION NAME: ENflush
+ *
+ * DESCRIPTION: Put the messages waiting in the outboxes in flight. Senders
+ * 				are visited from the highest id down, the order in which the
+ * 				application runs the nodes, and each outbox in send order, so
+ * 				the arrivals and the drop decisions do not depend on how the
+ * 				nodes were spread over threads.
+ */
+void EmulNet::ENflush() {
 	int time = par->getcurrtime();
 
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
+	emulnet.currbuffsize -= drained.exchange(0);
+
+	sort(senders.begin(), senders.end(), greater<int>());
+	for ( unsigned int k = 0; k < senders.size(); k++ ) {
+		int src = senders[k];
+		vector<en_msg *> &outbox = emulnet.outbox[src];
+		for ( unsigned int j = 0; j < outbox.size(); j++ ) {
+			en_msg *em = outbox[j];
+			int sendmsg = rng.below(100);
+			int size = em->size;
+			vector<en_msg *> *box = emulnet.getMailbox(*(int *)(em->to.addr));
+			int reason = -1;
+
+			if ( box == NULL ) {
+				reason = DROP_NOROUTE;
+			}
+			else if ( emulnet.currbuffsize >= buffsize ) {
+				reason = DROP_BUFFULL;
+			}
+			else if ( size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+				reason = DROP_OVERSIZE;
+			}
+			else if ( sideOf(src) != sideOf(*(int *)(em->to.addr)) ) {
+				reason = DROP_PARTITION;
+			}
+			else if ( cutDrops(src, *(int *)(em->to.addr)) ) {
+				reason = DROP_LINK;
+			}
+			else if ( par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100) ) {
+				reason = DROP_RANDOM;
+			}
+			if ( reason < 0 ) {
+				em->arrive = arrival(src, *(int *)(em->to.addr), size);
+				if ( em->arrive < 0 ) {
+					reason = DROP_QUEUE;
+				}
+			}
+			if ( reason >= 0 ) {
+				drop(reason);
+				em->buf->release();
+				slab.release(em);
+				continue;
+			}
 
-	sent_msgs[src][time]++;
+			emulnet.inflight.push(em->arrive, em);
+			emulnet.currbuffsize++;
 
-#ifdef DEBUGLOG
-  sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
-  //if (*(int *)data == 2)
-  //  printf ("%s\n", temp);
-#endif
+			stats.countSent(src, time, size);
+		}
+		outbox.clear();
+	}
+	senders.clear();
+}
 
-	return size;
+/**
+ * FUNCTION NAME: arrival
+ *
+ * DESCRIPTION: Virtual time at which a message of size bytes sent now from
+ * 				src reaches dst, or -1 if the uplink of src is too backed up
+ * 				to take it. The delay adds up:
+ * 				- the wait for the uplink of src and the time to send size
+ * 				  bytes on it, with BANDWIDTH set;
+ * 				- LATENCY plus a fixed part of LINK_SPREAD for the link;
+ * 				- a JITTER draw, and one more tick with probability REORDER.
+ * 				Jitter and REORDER let later messages overtake earlier ones.
+ */
+long EmulNet::arrival(int src, int dst, int size) {
+	long now = (long)par->getcurrtime() * SUBTICKS;
+	long depart = now;
+
+	if ( par->BANDWIDTH > 0 ) {
+		if ( src >= (int)busyUntil.size() ) {
+			busyUntil.resize(src + 1, 0);
+		}
+		long start = max(now, busyUntil[src]);
+		if ( par->QUEUE_LIMIT > 0 && start - now > (long)par->QUEUE_LIMIT * SUBTICKS ) {
+			return -1;
+		}
+		depart = start + ((long)size * SUBTICKS + par->BANDWIDTH - 1) / par->BANDWIDTH;
+		busyUntil[src] = depart;
+	}
+
+	double extra = 0;
+	if ( par->LINK_SPREAD > 0 ) {
+		uint64_t link = ((uint64_t)(uint32_t)src << 32) | (uint32_t)dst;
+		extra += par->LINK_SPREAD * Random::toUnit(Random::mix(link ^ ((uint64_t)par->SEED * 0x9E3779B97F4A7C15ULL)));
+	}
+	if ( par->JITTER > 0 ) {
+		double u = rng.uniform();
+		extra += par->JITTER_DIST == JITTER_EXPONENTIAL ? -par->JITTER * log(1 - u) : par->JITTER * u;
+	}
+	if ( par->REORDER > 0 && rng.uniform() < par->REORDER ) {
+		extra += 1;
+	}
+
+	long arrive = depart + latency + (long)(extra * SUBTICKS);
+	long delay = arrive - now;
+	delaySum += delay;
+	delayMax = max(delayMax, delay);
+	delayCount++;
+	return arrive;
+}
+
+/**
+ * FUNCTION NAME: drop
+ *
+ * DESCRIPTION: Count a message dropped by ENflush or discarded for a failed
+ * 				node. Oversized messages are a sender bug rather than
+ * 				network loss, so the first one is also reported on stderr.
+ *
+ * RETURNS:
+ * 0
+ */
+int EmulNet::drop(int reason) {
+	if ( reason == DROP_OVERSIZE && dropped[DROP_OVERSIZE] == 0 ) {
+		fprintf(stderr, "EmulNet: dropping messages larger than MAX_MSG_SIZE %d\n", par->MAX_MSG_SIZE);
+	}
+	dropped[reason]++;
+	return 0;
 }
 
 /**
@@ -127,14 +245,26 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
  * RETURNS:
  * size
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	MsgBuf *buf = ENalloc(size);
+	memcpy(buf->data(), data, size);
+	int ret = this->ENsend(myaddr, toaddr, buf);
+	buf->release();
 	return ret;
 }
 
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: EmulNet send function
+ *
+ * RETURNS:
+ * size
+ */
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
+	return this->ENsend(myaddr, toaddr, (char *)data.c_str(), (data.length() * sizeof(char)));
+}
+
 /**
  * FUNCTION NAME: ENrecv
  *
@@ -145,37 +275,225 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
  */
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
-	int i;
-	char* tmp;
-	int sz;
+	unsigned int i;
 	en_msg *emsg;
+	vector<en_msg *> *box = emulnet.getMailbox(*(int *)(myaddr->addr));
+
+	if ( box == NULL || box->empty() ) {
+		return 0;
+	}
+
+	int dst = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
+
+	// Drain only the messages addressed to this node, oldest first.
+	// The payload is handed over without a copy: the queue inherits the
+	// message's reference and the consumer releases it once handled.
+	// Nodes may receive concurrently, so they only add to drained, which
+	// ENflush takes off the shared in-flight count.
+	for( i = 0; i < box->size(); i++ ) {
+		emsg = (*box)[i];
 
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
+		(*enq)(queue, emsg->buf->data(), emsg->size);
 
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+		slab.release(emsg);
+	}
+	stats.countRecv(dst, time, box->size());
+	drained += box->size();
+	box->clear();
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+	return 0;
+}
 
-			(*enq)(queue, (char *)tmp, sz);
+/**
+ * FUNCTION NAME: ENalloc
+ *
+ * DESCRIPTION: Allocate a message buffer of size payload bytes from the
+ * 				network's slab. The caller holds the only reference.
+ */
+MsgBuf *EmulNet::ENalloc(int size) {
+	return MsgBuf::create(size, &slab);
+}
 
-			free(emsg);
+/**
+ * FUNCTION NAME: ENdeliver
+ *
+ * DESCRIPTION: Move the messages that have arrived by the start of this tick
+ * 				to the mailboxes, in arrival order, and append the ids of
+ * 				their destinations to woken. Those for failed nodes, which
+ * 				would never be received, are discarded.
+ */
+void EmulNet::ENdeliver(vector<int> &woken) {
+	long now = (long)par->getcurrtime() * SUBTICKS;
+	while ( !emulnet.inflight.empty() && emulnet.inflight.nextTime() <= now ) {
+		en_msg *em = emulnet.inflight.pop();
+		int dst = *(int *)(em->to.addr);
+		if ( dst < (int)down.size() && down[dst] ) {
+			discard(em);
+			continue;
+		}
+		emulnet.getMailbox(dst)->push_back(em);
+		woken.push_back(dst);
+	}
+}
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+/**
+ * FUNCTION NAME: ENnextTick
+ *
+ * DESCRIPTION: First tick at which a message in flight can be received, -1
+ * 				if none is in flight
+ */
+long EmulNet::ENnextTick() {
+	if ( emulnet.inflight.empty() ) {
+		return -1;
+	}
+	return (emulnet.inflight.nextTime() + SUBTICKS - 1) / SUBTICKS;
+}
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+/**
+ * FUNCTION NAME: ENpartition
+ *
+ * DESCRIPTION: Move a node to a partition side; 0 is the side every node
+ * 				starts on
+ */
+void EmulNet::ENpartition(Address *addr, int side) {
+	int id = *(int *)(addr->addr);
+	if ( id >= (int)this->side.size() ) {
+		this->side.resize(id + 1, 0);
+	}
+	this->side[id] = side;
+}
 
-			recv_msgs[dst][time]++;
+/**
+ * FUNCTION NAME: ENdown
+ *
+ * DESCRIPTION: Mark a node failed or back up. A failed node receives
+ * 				nothing, so what waits in its mailbox is discarded, and so is
+ * 				what reaches it later, rather than filling up the network.
+ */
+void EmulNet::ENdown(Address *addr, bool failed) {
+	int id = *(int *)(addr->addr);
+	if ( id >= (int)down.size() ) {
+		down.resize(id + 1, false);
+	}
+	down[id] = failed;
+	vector<en_msg *> *box = emulnet.getMailbox(id);
+	if ( failed && box != NULL ) {
+		for ( unsigned int i = 0; i < box->size(); i++ ) {
+			discard((*box)[i]);
 		}
+		box->clear();
 	}
+}
 
-	return 0;
+/**
+ * FUNCTION NAME: discard
+ *
+ * DESCRIPTION: Take a message in flight or in a mailbox out of the network,
+ * 				as dropped for a failed destination
+ */
+void EmulNet::discard(en_msg *em) {
+	drop(DROP_DOWN);
+	em->buf->release();
+	slab.release(em);
+	emulnet.currbuffsize--;
+}
+
+/**
+ * FUNCTION NAME: ENcut
+ *
+ * DESCRIPTION: Drop the messages from the nodes with ids srcFirst .. srcLast
+ * 				to the nodes with ids dstFirst .. dstLast with probability
+ * 				prob, in that direction only, until the heal of fault
+ */
+void EmulNet::ENcut(int srcFirst, int srcLast, int dstFirst, int dstLast, double prob, int fault) {
+	LinkCut cut;
+	cut.srcFirst = srcFirst;
+	cut.srcLast = srcLast;
+	cut.dstFirst = dstFirst;
+	cut.dstLast = dstLast;
+	cut.prob = prob;
+	cut.fault = fault;
+	cuts.push_back(cut);
+}
+
+/**
+ * FUNCTION NAME: cutDrops
+ *
+ * DESCRIPTION: Whether a link fault drops a message from src to dst. The
+ * 				random stream is only drawn from for a partial fault, so that
+ * 				runs without one see the same drops as before.
+ */
+bool EmulNet::cutDrops(int src, int dst) {
+	for ( unsigned int i = 0; i < cuts.size(); i++ ) {
+		LinkCut &cut = cuts[i];
+		if ( src < cut.srcFirst || src > cut.srcLast || dst < cut.dstFirst || dst > cut.dstLast ) {
+			continue;
+		}
+		if ( cut.prob >= 1 || rng.uniform() < cut.prob ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: ENheal
+ *
+ * DESCRIPTION: Undo fault: put the nodes on its partition side back on side
+ * 				0 and remove its link faults. Fault 0 undoes all of them.
+ */
+void EmulNet::ENheal(int fault) {
+	for ( unsigned int i = 0; i < side.size(); i++ ) {
+		if ( fault == 0 || side[i] == fault ) {
+			side[i] = 0;
+		}
+	}
+	unsigned int kept = 0;
+	for ( unsigned int i = 0; i < cuts.size(); i++ ) {
+		if ( fault != 0 && cuts[i].fault != fault ) {
+			cuts[kept++] = cuts[i];
+		}
+	}
+	cuts.resize(kept);
+}
+
+/**
+ * FUNCTION NAME: ENtick
+ *
+ * DESCRIPTION: Called once at the start of every tick
+ */
+void EmulNet::ENtick() {
+	if ( slab.getMode() == SLAB_TICK ) {
+		purgeStale();
+	}
+	slab.tick();
+}
+
+/**
+ * FUNCTION NAME: purgeStale
+ *
+ * DESCRIPTION: Drop the messages that have waited in a mailbox for more than
+ * 				a tick. Those are addressed to nodes that stopped receiving
+ * 				(failed nodes); their memory is about to be rewound.
+ */
+void EmulNet::purgeStale() {
+	int stale = par->getcurrtime() - 1;
+	for ( unsigned int i = 0; i < emulnet.mailbox.size(); i++ ) {
+		vector<en_msg *> &box = emulnet.mailbox[i];
+		unsigned int kept = 0;
+		for ( unsigned int j = 0; j < box.size(); j++ ) {
+			if ( box[j]->born < stale ) {
+				box[j]->buf->release();
+				slab.release(box[j]);
+				emulnet.currbuffsize--;
+			}
+			else {
+				box[kept++] = box[j];
+			}
+		}
+		box.resize(kept);
+	}
 }
 
 /**
@@ -186,36 +504,66 @@ int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct ti
 int EmulNet::ENcleanup() {
 	emulnet.nextid=0;
 	int i, j;
-	int sent_total, recv_total;
+	long all_bytes = 0;
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.outbox.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.outbox[i].size(); j++ ) {
+			emulnet.outbox[i][j]->buf->release();
+			slab.release(emulnet.outbox[i][j]);
+		}
+		emulnet.outbox[i].clear();
 	}
+	senders.clear();
+	while ( !emulnet.inflight.empty() ) {
+		en_msg *em = emulnet.inflight.pop();
+		em->buf->release();
+		slab.release(em);
+	}
+	for ( i = 0; i < (int)emulnet.mailbox.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.mailbox[i].size(); j++ ) {
+			emulnet.mailbox[i][j]->buf->release();
+			slab.release(emulnet.mailbox[i][j]);
+		}
+		emulnet.mailbox[i].clear();
+	}
+	emulnet.currbuffsize = 0;
 
+	// One (sent, recv) pair per bucket of stats.getWidth() ticks
+	int width = stats.getWidth();
+	int buckets = (par->getcurrtime() + width - 1) / width;
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
 		fprintf(file, "node %3d ", i);
-		sent_total = 0;
-		recv_total = 0;
 
-		for (j = 0; j < par->getcurrtime(); j++) {
+		for (j = 0; j < buckets; j++) {
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
 			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, " (%4d, %4d)", stats.getSent(i, j), stats.getRecv(i, j));
 				if (j % 10 == 9) {
 					fprintf(file, "\n         ");
 				}
 			}
 			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, "special %4d %4d %4d\n", j * width, stats.getSent(i, j), stats.getRecv(i, j));
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6ld  recv_total %6ld  sent_bytes %8ld\n\n", i, stats.getSentTotal(i), stats.getRecvTotal(i), stats.getSentBytes(i));
+		all_bytes += stats.getSentBytes(i);
+	}
+
+	fprintf(file, "sent_bytes %ld over %d ticks\n", all_bytes, par->getcurrtime());
+	if ( width > 1 ) {
+		fprintf(file, "ticks per bucket %d\n", width);
 	}
+	fprintf(file, "seed %d\n", par->SEED);
+	fprintf(file, "dropped noroute %ld buffull %ld oversize %ld partition %ld link %ld random %ld queue %ld down %ld\n", dropped[DROP_NOROUTE], dropped[DROP_BUFFULL], dropped[DROP_OVERSIZE], dropped[DROP_PARTITION], dropped[DROP_LINK], dropped[DROP_RANDOM], dropped[DROP_QUEUE], dropped[DROP_DOWN]);
+	fprintf(file, "delay mean %.3f max %.3f ticks\n", delayCount ? delaySum / delayCount / SUBTICKS : 0.0, (double)delayMax / SUBTICKS);
+
+	// How high the slab got depends on how the threads interleaved, so that
+	// goes to the metrics, leaving only what every run of the seed repeats
+	fprintf(file, "slab mode %s bytes_allocated %ld\n", slab.getMode() == SLAB_TICK ? "tick" : "freelist", slab.getBytesAllocated());
 
 	fclose(file);
 	return 0;
@@ -7,13 +7,24 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
+// Messages in flight before ENflush drops them as buffer full: BUFF_SIZE,
+// else ENBUFFPERNODE per node for each tick a message may be in flight, and
+// at least ENBUFFSIZE
 #define ENBUFFSIZE 30000
+#define ENBUFFPERNODE 100
+
+// Reasons for which ENsend drops a message; DROP_DOWN is a message that
+// reached a failed node, discarded instead of waiting in its mailbox
+enum dropReason { DROP_NOROUTE, DROP_BUFFULL, DROP_OVERSIZE, DROP_PARTITION, DROP_LINK, DROP_RANDOM, DROP_QUEUE, DROP_DOWN, DROP_REASONS };
 
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "MsgBuf.h"
+#include "Slab.h"
+#include "Random.h"
+#include "MsgStats.h"
+#include "EventQueue.h"
 
 using namespace std;
 
@@ -21,35 +32,70 @@ using namespace std;
  * Struct Name: en_msg
  */
 typedef struct en_msg {
-	// Number of bytes after the class
+	// Number of payload bytes
 	int size;
 	// Source node
 	Address from;
 	// Destination node
 	Address to;
+	// Payload, shared with the other destinations of the same send
+	MsgBuf *buf;
+	// Time at which the message was sent
+	int born;
+	// Virtual time (SUBTICKS per tick) at which it reaches the mailbox
+	long arrive;
 }en_msg;
 
 /**
  * Class Name: EM
+ *
+ * DESCRIPTION: In-flight messages, kept in one mailbox per destination node id
+ * 				so that a receive only touches the messages addressed to it.
+ * 				Sends first go to the outbox of the sending node, which lets
+ * 				the nodes send from several threads; ENflush then puts them
+ * 				in flight in a fixed order, and ENdeliver moves them to the
+ * 				mailboxes once their arrival time is reached.
  */
 class EM {
 public:
 	int nextid;
+	// Total number of messages in flight over all mailboxes
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	// mailbox[id] holds the messages addressed to node id, in send order
+	vector<vector<en_msg *> > mailbox;
+	// outbox[id] holds the messages sent by node id and not yet delivered
+	vector<vector<en_msg *> > outbox;
+	// messages between outbox and mailbox, by arrival time
+	EventQueue<en_msg *> inflight;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->mailbox = anotherEM.mailbox;
+		this->outbox = anotherEM.outbox;
+		this->inflight = anotherEM.inflight;
 		return *this;
 	}
+	vector<en_msg *> *getMailbox(int id) {
+		if ( id < 0 ) {
+			return NULL;
+		}
+		if ( id >= (int)mailbox.size() ) {
+			mailbox.resize(id + 1);
+		}
+		return &mailbox[id];
+	}
+	vector<en_msg *> *getOutbox(int id) {
+		if ( id < 0 ) {
+			return NULL;
+		}
+		if ( id >= (int)outbox.size() ) {
+			outbox.resize(id + 1);
+		}
+		return &outbox[id];
+	}
 	int getNextId() {
 		return nextid;
 	}
@@ -71,6 +117,22 @@ public:
 	virtual ~EM() {}
 };
 
+/**
+ * Struct Name: LinkCut
+ *
+ * DESCRIPTION: One way link fault: messages from the nodes with ids
+ * 				srcFirst .. srcLast to the nodes with ids dstFirst .. dstLast
+ * 				are dropped with probability prob, until the heal of fault
+ */
+typedef struct LinkCut {
+	int srcFirst;
+	int srcLast;
+	int dstFirst;
+	int dstLast;
+	double prob;
+	int fault;
+}LinkCut;
+
 /**
  * CLASS NAME: EmulNet
  *
@@ -80,19 +142,74 @@ class EmulNet
 { 	
 private:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	MsgStats stats;
+	long dropped[DROP_REASONS];
 	int enInited;
 	EM emulnet;
+	// Backs the message envelopes and payloads
+	SlabAllocator slab;
+	// Decides the random drops
+	Random rng;
+	// Base latency of every message, in virtual time units
+	long latency;
+	// Most messages in flight, see ENBUFFSIZE
+	long buffsize;
+	// Virtual time at which the uplink of node id is free again
+	vector<long> busyUntil;
+	// Sum and largest delay of the messages put in flight
+	double delaySum;
+	long delayMax;
+	long delayCount;
+	// Ids of the nodes with a non empty outbox
+	vector<int> senders;
+	mutex sendersLock;
+	// Messages taken out of the mailboxes since the last ENflush
+	atomic<int> drained;
+	// side[id] is the partition side of node id; messages only flow
+	// between nodes on the same side
+	vector<int> side;
+	int sideOf(int id) {
+		return id < (int)side.size() ? side[id] : 0;
+	}
+	// down[id] is set while node id is failed
+	vector<bool> down;
+	void discard(en_msg *em);
+	// Link faults set by ENcut, until their ENheal
+	vector<LinkCut> cuts;
+	bool cutDrops(int src, int dst);
+	void purgeStale();
+	int drop(int reason);
+	long arrival(int src, int dst, int size);
 public:
  	EmulNet(Params *p);
- 	EmulNet(EmulNet &anotherEmulNet);
- 	EmulNet& operator = (EmulNet &anotherEmulNet);
+ 	// The messages in flight live in the slab of their EmulNet, so an
+ 	// EmulNet cannot be copied
+ 	EmulNet(const EmulNet &anotherEmulNet) = delete;
+ 	EmulNet& operator = (const EmulNet &anotherEmulNet) = delete;
  	virtual ~EmulNet();
 	void *ENinit(Address *myaddr, short port);
 	int ENsend(Address *myaddr, Address *toaddr, string data);
 	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENsend(Address *myaddr, Address *toaddr, MsgBuf *buf);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	MsgBuf *ENalloc(int size);
+	void ENflush();
+	void ENdeliver(vector<int> &woken);
+	long ENnextTick();
+	MsgStats &ENstats() {
+		return stats;
+	}
+	SlabAllocator &ENslab() {
+		return slab;
+	}
+	long ENdropped(int reason) {
+		return dropped[reason];
+	}
+	void ENpartition(Address *addr, int side);
+	void ENdown(Address *addr, bool failed);
+	void ENcut(int srcFirst, int srcLast, int dstFirst, int dstLast, double prob, int fault);
+	void ENheal(int fault);
+	void ENtick();
 	int ENcleanup();
 };
 
@@ -0,0 +1,219 @@
+/**********************************
+ * FILE NAME: EventLog.cpp
+ *
+ * DESCRIPTION: Definition of the binary event log
+ **********************************/
+
+#include "EventLog.h"
+#include <sys/mman.h>
+
+/**
+ * Constructor
+ */
+EventLog::EventLog() {
+	fd = -1;
+	base = NULL;
+	mapped = 0;
+	used = 0;
+}
+
+/**
+ * Destructor
+ */
+EventLog::~EventLog() {
+	close();
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Create the file at path, with an empty header. Only the first
+ * 				call does anything. Returns false if the file cannot be
+ * 				created or mapped.
+ */
+bool EventLog::open(const char *path) {
+	lock_guard<mutex> guard(lock);
+	if ( fd >= 0 ) {
+		return true;
+	}
+	fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if ( fd < 0 ) {
+		return false;
+	}
+	used = sizeof(EventLogHeader);
+	if ( !reserve(0) ) {
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	EventLogHeader *header = (EventLogHeader *)base;
+	memcpy(header->magic, EVLOG_MAGIC, sizeof(header->magic));
+	header->version = EVLOG_VERSION;
+	header->recordSize = sizeof(LogRecord);
+	header->length = 0;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: reserve
+ *
+ * DESCRIPTION: Make room for len more bytes after the used ones, growing the
+ * 				file and mapping it again if needed. Called with lock held.
+ */
+bool EventLog::reserve(size_t len) {
+	if ( used + len <= mapped ) {
+		return true;
+	}
+	size_t grown = mapped;
+	while ( grown < used + len ) {
+		grown += EVLOG_GROW;
+	}
+	if ( ftruncate(fd, grown) != 0 ) {
+		return false;
+	}
+	if ( base != NULL ) {
+		munmap(base, mapped);
+	}
+	base = (char *)mmap(NULL, grown, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if ( base == MAP_FAILED ) {
+		base = NULL;
+		mapped = 0;
+		return false;
+	}
+	mapped = grown;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Append rec, followed by rec.length bytes of text for a
+ * 				LOGREC_TEXT record
+ */
+void EventLog::append(const LogRecord &rec, const char *text) {
+	lock_guard<mutex> guard(lock);
+	if ( base == NULL || !reserve(size(rec)) ) {
+		return;
+	}
+	memcpy(base + used, &rec, sizeof(rec));
+	if ( rec.type == LOGREC_TEXT ) {
+		// The mapping of a new file is zeros, so the padding already is
+		memcpy(base + used + sizeof(rec), text, rec.length);
+	}
+	used += size(rec);
+	((EventLogHeader *)base)->length = used - sizeof(EventLogHeader);
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Append len bytes of records built by pack()
+ */
+void EventLog::append(const char *records, size_t len) {
+	lock_guard<mutex> guard(lock);
+	if ( base == NULL || len == 0 || !reserve(len) ) {
+		return;
+	}
+	memcpy(base + used, records, len);
+	used += len;
+	((EventLogHeader *)base)->length = used - sizeof(EventLogHeader);
+}
+
+/**
+ * FUNCTION NAME: sync
+ *
+ * DESCRIPTION: Write the records appended so far back to the file
+ */
+void EventLog::sync() {
+	lock_guard<mutex> guard(lock);
+	if ( base != NULL ) {
+		msync(base, used, MS_SYNC);
+	}
+}
+
+/**
+ * FUNCTION NAME: close
+ *
+ * DESCRIPTION: Unmap the file and cut it to the used length
+ */
+void EventLog::close() {
+	lock_guard<mutex> guard(lock);
+	if ( fd < 0 ) {
+		return;
+	}
+	if ( base != NULL ) {
+		munmap(base, mapped);
+		base = NULL;
+	}
+	if ( ftruncate(fd, used) != 0 ) {
+		perror("EventLog");
+	}
+	::close(fd);
+	fd = -1;
+	mapped = 0;
+}
+
+/**
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Bytes taken by rec and the records holding its text
+ */
+size_t EventLog::size(const LogRecord &rec) {
+	size_t len = sizeof(rec);
+	if ( rec.type == LOGREC_TEXT ) {
+		len += (rec.length + sizeof(rec) - 1) / sizeof(rec) * sizeof(rec);
+	}
+	return len;
+}
+
+/**
+ * FUNCTION NAME: pack
+ *
+ * DESCRIPTION: Append rec and its text to out, padded as in the file
+ */
+void EventLog::pack(string *out, const LogRecord &rec, const char *text) {
+	out->append((const char *)&rec, sizeof(rec));
+	if ( rec.type == LOGREC_TEXT ) {
+		out->append(text, rec.length);
+		out->append(size(rec) - sizeof(rec) - rec.length, '\0');
+	}
+}
+
+/**
+ * FUNCTION NAME: render
+ *
+ * DESCRIPTION: Append the text Log writes for rec to dbg or stats
+ */
+void EventLog::render(const LogRecord &rec, const char *text, string *dbg, string *stats) {
+	char line[128];
+	char addr[30] = "";
+	int n;
+
+	if ( rec.type == LOGREC_MAGIC ) {
+		n = sprintf(line, "%x\n", rec.value);
+		dbg->append(line, n);
+		return;
+	}
+	if ( !(rec.flags & LOGREC_NOADDR) ) {
+		sprintf(addr, "%d.%d.%d.%d:%d ", rec.observer[0], rec.observer[1], rec.observer[2], rec.observer[3], *(short *)&rec.observer[4]);
+	}
+	n = sprintf(line, "\n %s[%d] ", addr, rec.time);
+
+	switch ( rec.type ) {
+		case LOGREC_TEXT:
+			if ( rec.flags & LOGREC_STATS ) {
+				stats->append(line, n);
+				stats->append(text, rec.length);
+			}
+			else {
+				dbg->append(line, n);
+				dbg->append(text, rec.length);
+			}
+			break;
+		case LOGREC_JOIN:
+		case LOGREC_REMOVE:
+			n += sprintf(line + n, "Node %d.%d.%d.%d:%d %s at time %d", rec.subject[0], rec.subject[1], rec.subject[2], rec.subject[3], *(short *)&rec.subject[4], rec.type == LOGREC_JOIN ? "joined" : "removed", rec.time);
+			dbg->append(line, n);
+			break;
+	}
+}
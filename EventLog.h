@@ -0,0 +1,88 @@
+/**********************************
+ * FILE NAME: EventLog.h
+ *
+ * DESCRIPTION: Header file of the binary event log
+ **********************************/
+
+#ifndef _EVENTLOG_H_
+#define _EVENTLOG_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Macros
+ */
+#define EVLOG_MAGIC "MP1EVLOG"
+#define EVLOG_VERSION 1
+// bytes by which the file and its mapping grow
+#define EVLOG_GROW (1 << 24)
+// flags of a LogRecord
+#define LOGREC_NOADDR 1             // the line has no observer address
+#define LOGREC_STATS 2              // the line goes to stats.log
+
+// Kinds of record
+enum logrecTYPE { LOGREC_END, LOGREC_MAGIC, LOGREC_TEXT, LOGREC_JOIN, LOGREC_REMOVE };
+
+/**
+ * STRUCT NAME: EventLogHeader
+ *
+ * DESCRIPTION: First bytes of the file. length is kept current after every
+ * 				append, so a file left by a crashed run is still readable.
+ */
+typedef struct EventLogHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+	uint64_t length;            // bytes of records after the header
+	uint64_t spare;
+}EventLogHeader;
+
+/**
+ * STRUCT NAME: LogRecord
+ *
+ * DESCRIPTION: One fixed size record. A join or a removal is a single
+ * 				record; the text of a LOGREC_TEXT line fills the records that
+ * 				follow it, padded with zeros to a whole record.
+ */
+typedef struct LogRecord {
+	uint8_t type;
+	uint8_t flags;
+	uint16_t spare;
+	int32_t time;
+	char observer[6];
+	char subject[6];
+	uint32_t length;            // LOGREC_TEXT: bytes of text
+	uint32_t value;             // LOGREC_MAGIC: the magic number
+	uint32_t spare2;
+}LogRecord;
+
+/**
+ * CLASS NAME: EventLog
+ *
+ * DESCRIPTION: Appends records to a file mapped in memory, growing the file
+ * 				and the mapping by EVLOG_GROW bytes when full. render() turns
+ * 				records back into the exact text of dbg.log and stats.log.
+ */
+class EventLog {
+private:
+	int fd;
+	char *base;
+	size_t mapped;
+	size_t used;
+	mutex lock;
+	bool reserve(size_t len);
+public:
+	EventLog();
+	virtual ~EventLog();
+	bool open(const char *path);
+	void append(const LogRecord &rec, const char *text);
+	void append(const char *records, size_t len);
+	void sync();
+	void close();
+	static size_t size(const LogRecord &rec);
+	static void pack(string *out, const LogRecord &rec, const char *text);
+	static void render(const LogRecord &rec, const char *text, string *dbg, string *stats);
+};
+
+#endif /* _EVENTLOG_H_ */
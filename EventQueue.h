@@ -0,0 +1,61 @@
+/**********************************
+ * FILE NAME: EventQueue.h
+ *
+ * DESCRIPTION: Header file of the virtual time priority queue of the
+ * 				simulation
+ **********************************/
+
+#ifndef _EVENTQUEUE_H_
+#define _EVENTQUEUE_H_
+
+#include "stdincludes.h"
+
+/**
+ * CLASS NAME: EventQueue
+ *
+ * DESCRIPTION: Items keyed by the virtual time at which they are due.
+ * 				Items due at the same time come out in the order they were
+ * 				pushed, so a run does not depend on how the heap breaks ties.
+ */
+template <typename T>
+class EventQueue {
+private:
+	struct Entry {
+		long when;
+		long seq;
+		T item;
+	};
+	struct Later {
+		bool operator()(const Entry &a, const Entry &b) const {
+			if ( a.when != b.when ) {
+				return a.when > b.when;
+			}
+			return a.seq > b.seq;
+		}
+	};
+	priority_queue<Entry, vector<Entry>, Later> heap;
+	long seq;
+public:
+	EventQueue(): seq(0) {}
+	void push(long when, const T &item) {
+		Entry e = { when, seq++, item };
+		heap.push(e);
+	}
+	bool empty() {
+		return heap.empty();
+	}
+	size_t size() {
+		return heap.size();
+	}
+	// time of the earliest item; the queue must not be empty
+	long nextTime() {
+		return heap.top().when;
+	}
+	T pop() {
+		T item = heap.top().item;
+		heap.pop();
+		return item;
+	}
+};
+
+#endif /* _EVENTQUEUE_H_ */
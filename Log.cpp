@@ -6,6 +6,13 @@
 
 #include "Log.h"
 
+// Shared by all the Log objects, opened by the first LOG
+static LogWriter writer;
+static EventLog events;
+static atomic<int> dbg_opened(0);
+// Where the lines of the calling thread go instead of the files, if set
+static thread_local LogSink *sink = NULL;
+
 /**
  * Constructor
  */
@@ -43,30 +50,15 @@ Log::~Log() {}
  */
 void Log::LOG(Address *addr, const char * str, ...) {
 
-	static FILE *fp;
-	static FILE *fp2;
 	va_list vararglist;
-	static char buffer[30000];
-	static int numwrites;
-	static char stdstring[30];
-	static char stdstring2[40];
-	static char stdstring3[40]; 
-	static int dbg_opened=0;
+	static thread_local char buffer[30000];
+	static thread_local char stdstring[30];
+	static thread_local char prefix[64];
+	bool noaddr = false;
 
 	if(dbg_opened != 639){
-		numwrites=0;
-
-		stdstring2[0]=0;
-
-		strcpy(stdstring3, stdstring2);
-
-		strcat(stdstring2, DBG_LOG);
-		strcat(stdstring3, STATS_LOG);
-
-		fp = fopen(stdstring2, "w");
-		fp2 = fopen(stdstring3, "w");
-
-		dbg_opened=639;
+		openFiles();
+		noaddr = true;
 	}
 	else 
 
@@ -76,6 +68,57 @@ void Log::LOG(Address *addr, const char * str, ...) {
 	vsprintf(buffer, str, vararglist);
 	va_end(vararglist);
 
+	writeMagic();
+
+	int stats = memcmp(buffer, "#STATSLOG#", 10) == 0;
+
+	if ( par->LOG_BINARY ) {
+		LogRecord rec = record(LOGREC_TEXT, addr, noaddr);
+		rec.flags |= stats ? LOGREC_STATS : 0;
+		rec.length = strlen(buffer);
+		if ( sink != NULL ) {
+			EventLog::pack(&sink->events, rec, buffer);
+		}
+		else {
+			events.append(rec, buffer);
+		}
+		return;
+	}
+
+	int n = sprintf(prefix, "\n %s[%d] ", stdstring, par->getcurrtime());
+
+	if ( sink != NULL ) {
+		string &lines = stats ? sink->stats : sink->dbg;
+		lines.append(prefix, n);
+		lines += buffer;
+		return;
+	}
+
+	writer.append(stats ? LOG_STATS : LOG_DBG, prefix, n);
+	writer.append(stats ? LOG_STATS : LOG_DBG, buffer, strlen(buffer));
+}
+
+/**
+ * FUNCTION NAME: openFiles
+ *
+ * DESCRIPTION: Create dbg.log and stats.log, or dbg.bin in binary mode
+ */
+void Log::openFiles() {
+	if ( par->LOG_BINARY ) {
+		events.open(BIN_LOG);
+	}
+	else {
+		writer.open(DBG_LOG, STATS_LOG);
+	}
+	dbg_opened = 639;
+}
+
+/**
+ * FUNCTION NAME: writeMagic
+ *
+ * DESCRIPTION: Start the output of this Log with the magic number line
+ */
+void Log::writeMagic() {
 	if (!firstTime) {
 		int magicNumber = 0;
 		string magic = MAGIC_NUMBER;
@@ -83,29 +126,97 @@ void Log::LOG(Address *addr, const char * str, ...) {
 		for ( int i = 0; i < len; i++ ) {
 			magicNumber += (int)magic.at(i);
 		}
-		fprintf(fp, "%x\n", magicNumber);
+		if ( par->LOG_BINARY ) {
+			LogRecord rec = record(LOGREC_MAGIC, NULL, true);
+			rec.value = magicNumber;
+			events.append(rec, NULL);
+		}
+		else {
+			char line[16];
+			int n = sprintf(line, "%x\n", magicNumber);
+			writer.append(LOG_DBG, line, n);
+		}
 		firstTime = true;
 	}
+}
 
-	if(memcmp(buffer, "#STATSLOG#", 10)==0){
-		fprintf(fp2, "\n %s", stdstring);
-		fprintf(fp2, "[%d] ", par->getcurrtime());
-
-		fprintf(fp2, buffer);
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: A binary log record of the given type logged now by addr
+ */
+LogRecord Log::record(int type, Address *addr, bool noaddr) {
+	LogRecord rec;
+	memset(&rec, 0, sizeof(rec));
+	rec.type = type;
+	rec.flags = noaddr ? LOGREC_NOADDR : 0;
+	rec.time = par->getcurrtime();
+	if ( addr != NULL ) {
+		memcpy(rec.observer, addr->addr, sizeof(rec.observer));
 	}
-	else{
-		fprintf(fp, "\n %s", stdstring);
-		fprintf(fp, "[%d] ", par->getcurrtime());
-		fprintf(fp, buffer);
+	return rec;
+}
 
+/**
+ * FUNCTION NAME: logEvent
+ *
+ * DESCRIPTION: Log a join or a removal as a single binary record
+ */
+void Log::logEvent(int type, Address *thisNode, Address *subject) {
+	bool noaddr = false;
+	if ( dbg_opened != 639 ) {
+		openFiles();
+		noaddr = true;
+	}
+	writeMagic();
+	LogRecord rec = record(type, thisNode, noaddr);
+	memcpy(rec.subject, subject->addr, sizeof(rec.subject));
+	if ( sink != NULL ) {
+		EventLog::pack(&sink->events, rec, NULL);
+	}
+	else {
+		events.append(rec, NULL);
 	}
+}
+
+/**
+ * FUNCTION NAME: capture
+ *
+ * DESCRIPTION: Collect the lines logged by the calling thread in s rather
+ * 				than writing them, until capture(NULL)
+ */
+void Log::capture(LogSink *s) {
+	sink = s;
+}
 
-	if(++numwrites >= MAXWRITES){
-		fflush(fp);
-		fflush(fp2);
-		numwrites=0;
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Write out and empty the lines collected in s
+ */
+void Log::flush(LogSink *s) {
+	if ( !s->dbg.empty() ) {
+		writer.append(LOG_DBG, s->dbg.data(), s->dbg.size());
+		s->dbg.clear();
+	}
+	if ( !s->stats.empty() ) {
+		writer.append(LOG_STATS, s->stats.data(), s->stats.size());
+		s->stats.clear();
 	}
+	if ( !s->events.empty() ) {
+		events.append(s->events.data(), s->events.size());
+		s->events.clear();
+	}
+}
 
+/**
+ * FUNCTION NAME: sync
+ *
+ * DESCRIPTION: Return once everything logged so far is in the files
+ */
+void Log::sync() {
+	writer.flush();
+	events.sync();
 }
 
 /**
@@ -114,7 +225,11 @@ void Log::LOG(Address *addr, const char * str, ...) {
  * DESCRIPTION: To Log a node add
  */
 void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
-	static char stdstring[100];
+	if ( par->LOG_BINARY ) {
+		logEvent(LOGREC_JOIN, thisNode, addedAddr);
+		return;
+	}
+	static thread_local char stdstring[100];
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", addedAddr->addr[0], addedAddr->addr[1], addedAddr->addr[2], addedAddr->addr[3], *(short *)&addedAddr->addr[4], par->getcurrtime());
     LOG(thisNode, stdstring);
 }
@@ -125,7 +240,11 @@ void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
  * DESCRIPTION: To log a node remove
  */
 void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
-	static char stdstring[30];
+	if ( par->LOG_BINARY ) {
+		logEvent(LOGREC_REMOVE, thisNode, removedAddr);
+		return;
+	}
+	static thread_local char stdstring[100];
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", removedAddr->addr[0], removedAddr->addr[1], removedAddr->addr[2], removedAddr->addr[3], *(short *)&removedAddr->addr[4], par->getcurrtime());
     LOG(thisNode, stdstring);
 }
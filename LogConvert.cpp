@@ -0,0 +1,81 @@
+/**********************************
+ * FILE NAME: LogConvert.cpp
+ *
+ * DESCRIPTION: Renders the dbg.log and stats.log of a run from its binary
+ * 				event log (LOG_BINARY: 1)
+ *
+ * 				usage: logconvert [dbg.bin [dbg.log [stats.log]]]
+ **********************************/
+
+#include "Log.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * FUNCTION NAME: writeFile
+ *
+ * DESCRIPTION: Write text to the file at path
+ */
+static bool writeFile(const char *path, const string &text) {
+	FILE *fp = fopen(path, "w");
+	if ( fp == NULL ) {
+		perror(path);
+		return false;
+	}
+	fwrite(text.data(), 1, text.size(), fp);
+	fclose(fp);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: Read the records of the binary log in order and write the
+ * 				text they stand for
+ */
+int main(int argc, char *argv[]) {
+	const char *bin = argc > 1 ? argv[1] : BIN_LOG;
+	const char *dbgPath = argc > 2 ? argv[2] : DBG_LOG;
+	const char *statsPath = argc > 3 ? argv[3] : STATS_LOG;
+	struct stat st;
+
+	int fd = open(bin, O_RDONLY);
+	if ( fd < 0 || fstat(fd, &st) != 0 ) {
+		perror(bin);
+		return FAILURE;
+	}
+	if ( (size_t)st.st_size < sizeof(EventLogHeader) ) {
+		fprintf(stderr, "%s: not an event log\n", bin);
+		return FAILURE;
+	}
+	char *base = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if ( base == MAP_FAILED ) {
+		perror(bin);
+		return FAILURE;
+	}
+	EventLogHeader *header = (EventLogHeader *)base;
+	if ( memcmp(header->magic, EVLOG_MAGIC, sizeof(header->magic)) != 0 || header->version != EVLOG_VERSION || header->recordSize != sizeof(LogRecord) ) {
+		fprintf(stderr, "%s: not an event log of this version\n", bin);
+		return FAILURE;
+	}
+
+	string dbg, stats;
+	size_t pos = sizeof(EventLogHeader);
+	size_t end = min((size_t)st.st_size, (size_t)(pos + header->length));
+	while ( pos + sizeof(LogRecord) <= end ) {
+		LogRecord *rec = (LogRecord *)(base + pos);
+		if ( rec->type == LOGREC_END || pos + EventLog::size(*rec) > end ) {
+			break;
+		}
+		EventLog::render(*rec, base + pos + sizeof(LogRecord), &dbg, &stats);
+		pos += EventLog::size(*rec);
+	}
+
+	munmap(base, st.st_size);
+	close(fd);
+
+	if ( !writeFile(dbgPath, dbg) || !writeFile(statsPath, stats) ) {
+		return FAILURE;
+	}
+	return SUCCESS;
+}
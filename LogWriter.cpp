@@ -0,0 +1,251 @@
+/**********************************
+ * FILE NAME: LogWriter.cpp
+ *
+ * DESCRIPTION: Definition of the background writer of the log files
+ **********************************/
+
+#include "LogWriter.h"
+
+thread_local LogRing *LogWriter::ring = NULL;
+
+/**
+ * FUNCTION NAME: copyIn
+ *
+ * DESCRIPTION: Copy len bytes to the ring at position pos, wrapping around
+ */
+void LogRing::copyIn(size_t pos, const char *from, size_t len) {
+	size_t at = pos & (LOG_RING_SIZE - 1);
+	size_t first = min(len, (size_t)LOG_RING_SIZE - at);
+	memcpy(data + at, from, first);
+	memcpy(data, from + first, len - first);
+}
+
+/**
+ * FUNCTION NAME: copyOut
+ *
+ * DESCRIPTION: Copy len bytes from the ring at position pos, wrapping around
+ */
+void LogRing::copyOut(size_t pos, char *to, size_t len) {
+	size_t at = pos & (LOG_RING_SIZE - 1);
+	size_t first = min(len, (size_t)LOG_RING_SIZE - at);
+	memcpy(to, data + at, first);
+	memcpy(to + first, data, len - first);
+}
+
+/**
+ * FUNCTION NAME: put
+ *
+ * DESCRIPTION: Append a record of len bytes for file. Returns false, and
+ * 				appends nothing, if the ring has no room for it.
+ */
+bool LogRing::put(int file, const char *text, size_t len) {
+	size_t t = tail.load(memory_order_relaxed);
+	uint32_t size = (uint32_t)len;
+	char tag = (char)file;
+
+	if ( 1 + sizeof(size) + len > LOG_RING_SIZE - (t - head.load(memory_order_acquire)) ) {
+		return false;
+	}
+	copyIn(t, &tag, 1);
+	copyIn(t + 1, (char *)&size, sizeof(size));
+	copyIn(t + 1 + sizeof(size), text, len);
+	tail.store(t + 1 + sizeof(size) + len, memory_order_release);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: take
+ *
+ * DESCRIPTION: Move the records in the ring to the end of files[file].
+ * 				Returns true if there were any.
+ */
+bool LogRing::take(string *files) {
+	size_t h = head.load(memory_order_relaxed);
+	size_t t = tail.load(memory_order_acquire);
+	if ( h == t ) {
+		return false;
+	}
+	while ( h != t ) {
+		char tag;
+		uint32_t size;
+		copyOut(h, &tag, 1);
+		copyOut(h + 1, (char *)&size, sizeof(size));
+		string &out = files[(int)tag];
+		size_t end = out.size();
+		out.resize(end + size);
+		copyOut(h + 1 + sizeof(size), &out[end], size);
+		h += 1 + sizeof(size) + size;
+	}
+	head.store(h, memory_order_release);
+	return true;
+}
+
+/**
+ * Constructor
+ */
+LogWriter::LogWriter() {
+	for ( int i = 0; i < LOG_FILES; i++ ) {
+		fds[i] = -1;
+	}
+	flushRequested = flushDone = 0;
+	stopping = false;
+}
+
+/**
+ * Destructor
+ */
+LogWriter::~LogWriter() {
+	close();
+	for ( unsigned int i = 0; i < rings.size(); i++ ) {
+		delete rings[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Create the log files and start the writer thread. Only the
+ * 				first call does anything.
+ */
+void LogWriter::open(const char *dbg, const char *stats) {
+	lock_guard<mutex> guard(lock);
+	if ( worker.joinable() ) {
+		return;
+	}
+	fds[LOG_DBG] = ::open(dbg, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	fds[LOG_STATS] = ::open(stats, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	stopping = false;
+	worker = thread(&LogWriter::run, this);
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Queue len bytes of text for file. Never blocks on the
+ * 				writer unless the ring of the calling thread is full.
+ */
+void LogWriter::append(int file, const char *text, size_t len) {
+	if ( ring == NULL ) {
+		ring = new LogRing();
+		lock_guard<mutex> guard(lock);
+		rings.push_back(ring);
+	}
+	while ( len > 0 ) {
+		// Pieces of a quarter of the ring always fit once it drains
+		size_t part = min(len, (size_t)LOG_RING_SIZE / 4);
+		while ( !ring->put(file, text, part) ) {
+			wake.notify_one();
+			this_thread::yield();
+		}
+		text += part;
+		len -= part;
+	}
+	if ( ring->used() > LOG_RING_SIZE / 2 ) {
+		wake.notify_one();
+	}
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Return once everything appended so far by any thread is
+ * 				written to the files
+ */
+void LogWriter::flush() {
+	unique_lock<mutex> guard(lock);
+	if ( !worker.joinable() ) {
+		return;
+	}
+	long ticket = ++flushRequested;
+	wake.notify_one();
+	flushed.wait(guard, [this, ticket]() { return flushDone >= ticket; });
+}
+
+/**
+ * FUNCTION NAME: close
+ *
+ * DESCRIPTION: Write out everything, stop the writer thread and close the
+ * 				files
+ */
+void LogWriter::close() {
+	{
+		lock_guard<mutex> guard(lock);
+		if ( !worker.joinable() ) {
+			return;
+		}
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+	for ( int i = 0; i < LOG_FILES; i++ ) {
+		if ( fds[i] >= 0 ) {
+			::close(fds[i]);
+			fds[i] = -1;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Body of the writer thread
+ */
+void LogWriter::run() {
+	unique_lock<mutex> guard(lock);
+	for ( ;; ) {
+		long request = flushRequested;
+		bool stop = stopping;
+		bool busy = drain();
+		if ( !busy || request != flushDone || stop ) {
+			for ( int i = 0; i < LOG_FILES; i++ ) {
+				writeOut(i);
+			}
+			flushDone = request;
+			flushed.notify_all();
+		}
+		if ( stop ) {
+			break;
+		}
+		// Sleep even when busy: the producers wake us once a ring is half full
+		wake.wait_for(guard, chrono::milliseconds(LOG_IDLE_MS), [this]() {
+			return stopping || flushRequested != flushDone;
+		});
+	}
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Move the records of all the rings to the batches, writing
+ * 				out the batches that are full. Returns true if there were
+ * 				any records.
+ */
+bool LogWriter::drain() {
+	bool any = false;
+	for ( unsigned int i = 0; i < rings.size(); i++ ) {
+		any |= rings[i]->take(batch);
+	}
+	for ( int i = 0; i < LOG_FILES; i++ ) {
+		if ( batch[i].size() >= LOG_BATCH_SIZE ) {
+			writeOut(i);
+		}
+	}
+	return any;
+}
+
+/**
+ * FUNCTION NAME: writeOut
+ *
+ * DESCRIPTION: Write the batch of a file and empty it
+ */
+void LogWriter::writeOut(int file) {
+	size_t done = 0;
+	while ( done < batch[file].size() && fds[file] >= 0 ) {
+		ssize_t n = write(fds[file], batch[file].data() + done, batch[file].size() - done);
+		if ( n <= 0 ) {
+			break;
+		}
+		done += n;
+	}
+	batch[file].clear();
+}
@@ -0,0 +1,92 @@
+/**********************************
+ * FILE NAME: LogWriter.h
+ *
+ * DESCRIPTION: Header file of the background writer of the log files
+ **********************************/
+
+#ifndef _LOGWRITER_H_
+#define _LOGWRITER_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// bytes of the ring of each logging thread (a power of two)
+#define LOG_RING_SIZE (1 << 20)
+// bytes gathered for a file before the writer writes them
+#define LOG_BATCH_SIZE (1 << 16)
+// milliseconds the writer sleeps when nobody wakes it
+#define LOG_IDLE_MS 20
+
+// Files a record can go to
+enum logFILE { LOG_DBG, LOG_STATS, LOG_FILES };
+
+/**
+ * CLASS NAME: LogRing
+ *
+ * DESCRIPTION: Single producer, single consumer ring of log records. The
+ * 				thread owning the ring appends with put(), the writer thread
+ * 				consumes with take(); head and tail are the only shared
+ * 				state, so neither side takes a lock. A record is a file byte,
+ * 				a 4 byte length and the text.
+ */
+class LogRing {
+private:
+	char data[LOG_RING_SIZE];
+	void copyIn(size_t pos, const char *from, size_t len);
+	void copyOut(size_t pos, char *to, size_t len);
+public:
+	// next byte to read, moved by the writer only
+	atomic<size_t> head;
+	// next byte to write, moved by the owner only
+	atomic<size_t> tail;
+	LogRing(): head(0), tail(0) {}
+	size_t used() {
+		return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+	}
+	bool put(int file, const char *text, size_t len);
+	bool take(string *files);
+};
+
+/**
+ * CLASS NAME: LogWriter
+ *
+ * DESCRIPTION: Writes the log files from a background thread. Each thread
+ * 				that logs gets its own LogRing on its first append(); the
+ * 				writer drains the rings into one batch per file and writes a
+ * 				batch with a single write() once it holds LOG_BATCH_SIZE
+ * 				bytes, when it goes idle, and on flush().
+ *
+ * 				Records of one thread keep their order; records of different
+ * 				threads are not ordered, which is why the application
+ * 				replays the output of the nodes through one thread.
+ */
+class LogWriter {
+private:
+	int fds[LOG_FILES];
+	string batch[LOG_FILES];
+	vector<LogRing *> rings;
+	// Guards rings and the flush counters; held by the writer while it
+	// drains and released while it sleeps
+	mutex lock;
+	condition_variable wake;
+	condition_variable flushed;
+	long flushRequested;
+	long flushDone;
+	bool stopping;
+	thread worker;
+	static thread_local LogRing *ring;
+	void run();
+	bool drain();
+	void writeOut(int file);
+public:
+	LogWriter();
+	virtual ~LogWriter();
+	void open(const char *dbg, const char *stats);
+	void append(int file, const char *text, size_t len);
+	void flush();
+	void close();
+};
+
+#endif /* _LOGWRITER_H_ */
@@ -27,22 +27,38 @@ short portFromAddress(Address addr){
   return *(short *) &addr.addr[4];
 }
 
-int mleSize();
-
 /**
  * Overloaded Constructor of the MP1Node class
  * You can add new members to the class if you think it
  * is necessary for your logic to work
  */
-MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address, Metrics *metrics) {
 	for( int i = 0; i < 6; i++ ) {
 		NULLADDR[i] = 0;
 	}
 	this->memberNode = member;
 	this->emulNet = emul;
 	this->log = log;
+	this->metrics = metrics;
 	this->par = params;
 	this->memberNode->addr = *address;
+	this->gossipInterval = 1;
+	this->lastGossip = 0;
+	this->stableSince = 0;
+	this->lastSuspects = 0;
+	this->membershipChanged = false;
+	this->introRetries = 0;
+	this->introNext = -1;
+	this->probing = false;
+	this->probeAcked = false;
+	this->probeSeq = 0;
+	this->probeStart = 0;
+	this->probeId = 0;
+	this->probePort = 0;
+	this->probeNext = 0;
+	// Own random stream, so that nodes running on different threads neither
+	// race on nor reorder a shared generator
+	this->rng.seed(par->SEED, RNG_STREAM_NODE(idFromAddress(*address)));
 }
 
 /**
@@ -88,17 +104,15 @@ void MP1Node::nodeStart(char *servaddrstr, short servport) {
 
   // Self booting routines
   if( initThisNode(&joinaddr) == -1 ) {
-#ifdef DEBUGLOG
-    log->LOG(&memberNode->addr, "init_thisnode failed. Exit.");
-#endif
+    if (Log::enabled<LOG_MEMBERSHIP, LOGLEVEL_ERROR>())
+      log->LOG(&memberNode->addr, "init_thisnode failed. Exit.");
     exit(1);
   }
 
   if( !introduceSelfToGroup(&joinaddr) ) {
     finishUpThisNode();
-#ifdef DEBUGLOG
-    log->LOG(&memberNode->addr, "Unable to join self to group. Exiting.");
-#endif
+    if (Log::enabled<LOG_MEMBERSHIP, LOGLEVEL_ERROR>())
+      log->LOG(&memberNode->addr, "Unable to join self to group. Exiting.");
     exit(1);
   }
 
@@ -123,9 +137,14 @@ int MP1Node::initThisNode(Address *joinaddr) {
   // node is up!
 	memberNode->nnb = 0;
 	memberNode->heartbeat = 0;
+	// A restart starts the heartbeat over, so tell it apart from the last run
+	memberNode->incarnation++;
 	memberNode->pingCounter = TFAIL;
 	memberNode->timeOutCounter = -1;
+	introRetries = 0;
+	introNext = -1;
   initMemberListTable(memberNode);
+  metrics->nodeStarted(id, par->getcurrtime());
 
   return 0;
 }
@@ -137,37 +156,36 @@ int MP1Node::initThisNode(Address *joinaddr) {
  */
 int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 	MessageHdr *msg;
-#ifdef DEBUGLOG
-  static char s[1024];
-#endif
 
   if ( 0 == memcmp((char *)&(memberNode->addr.addr),
                    (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
     // I am the group booter (first process to join the group). Boot up the group
-#ifdef DEBUGLOG
-    log->LOG(&memberNode->addr, "Starting up group...");
-#endif
+    if (Log::enabled<LOG_MEMBERSHIP>())
+      log->LOG(&memberNode->addr, "Starting up group...");
 
     addSelfToGroup();
   }
   else {
-    size_t msgsize = sizeof(MessageHdr) + sizeof(joinaddr->addr) + sizeof(long) + 1;
-    msg = (MessageHdr *) malloc(msgsize * sizeof(char));
+    size_t msgsize = sizeof(MessageHdr) + 1 + 2*WIRE_VARINT32_MAX + 2*WIRE_VARINT64_MAX;
+    MsgBuf *buf = emulNet->ENalloc(msgsize);
+    msg = (MessageHdr *) buf->data();
 
-    // create JOINREQ message: format of data is {struct Address myaddr}
+    // create JOINREQ message: format of data is {version, id, port, incarnation, heartbeat}
     msg->msgType = JOINREQ;
-    memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-    memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr),
-           &memberNode->heartbeat, sizeof(long));
-
-#ifdef DEBUGLOG
-    sprintf(s, "Trying to join...");
-    log->LOG(&memberNode->addr, s);
-#endif
+    WireWriter w((char *)(msg+1));
+    w.putByte(WIRE_VERSION);
+    w.putVarint((uint32_t)idFromAddress(memberNode->addr));
+    w.putSigned(portFromAddress(memberNode->addr));
+    w.putVarint(memberNode->incarnation);
+    w.putSigned(memberNode->heartbeat);
+    buf->size = sizeof(MessageHdr) + w.size();
+
+    if (Log::enabled<LOG_MEMBERSHIP>())
+      log->LOG(&memberNode->addr, "Trying to join...");
     // send JOINREQ message to introducer member
-    emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
+    emulNet->ENsend(&memberNode->addr, joinaddr, buf);
 
-    free(msg);
+    buf->release();
   }
 
   return 1;
@@ -180,9 +198,29 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
  * DESCRIPTION: Wind up this node and clean up state
  */
 int MP1Node::finishUpThisNode(){
-  /*
-   * Your code goes here
-   */
+  // Drop the messages received but not handled yet
+  while ( !memberNode->mp1q.empty() ) {
+    MsgBuf::fromData(memberNode->mp1q.front().elt)->release();
+    memberNode->mp1q.pop();
+  }
+
+  memberNode->inited = false;
+  memberNode->inGroup = false;
+  memberNode->nnb = 0;
+  memberNode->heartbeat = 0;
+  memberNode->myPos = 0;
+  initMemberListTable(memberNode);
+  suspectMask.clear();
+  expireMask.clear();
+  order.clear();
+  gossipInterval = 1;
+  lastGossip = 0;
+  stableSince = 0;
+  lastSuspects = 0;
+  membershipChanged = false;
+  probing = false;
+  probeOrder.clear();
+  probeNext = 0;
   return 0;
 }
 
@@ -206,7 +244,10 @@ void MP1Node::nodeLoop() {
   }
 
   // ...then jump in and share your responsibilites!
-  nodeLoopOps();
+  if (par->PROTOCOL == PROTOCOL_SWIM)
+    swimLoopOps();
+  else
+    nodeLoopOps();
 
   return;
 }
@@ -226,6 +267,8 @@ void MP1Node::checkMessages() {
     size = memberNode->mp1q.front().size;
     memberNode->mp1q.pop();
     recvCallBack((void *)memberNode, (char *)ptr, size);
+    // Drop the reference EmulNet handed over with the message
+    MsgBuf::fromData(ptr)->release();
   }
   return;
 }
@@ -242,57 +285,51 @@ bool MP1Node::recvCallBack(void *env, char *data, int size) {
 
   MessageHdr *msg_recv = (MessageHdr *) data;
   if (msg_recv->msgType == JOINREQ){
-    MessageHdr *msg;
-      
     //Add to MemberList
-    MemberListEntry mle; char *itr = (data+sizeof(MessageHdr));
-    Address memAddr; long heartbeat;
-    memcpy (&memAddr.addr, (char *)(itr), sizeof(memAddr.addr));
-    itr += sizeof(memAddr.addr);
-    itr++;
-    memcpy (&heartbeat, (char *)(itr), sizeof(long));
-    itr += sizeof(long);
-
-    mle.id = *(int*)(&memAddr.addr);
-    mle.port = *(short*)(&memAddr.addr[4]);
-    mle.heartbeat = heartbeat;
+    MemberListEntry mle;
+    WireReader r(data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+    if (r.getByte() != WIRE_VERSION)
+      return 0;
+    mle.id = (int)r.getVarint();
+    mle.port = (short)r.getSigned();
+    mle.incarnation = (long)r.getVarint();
+    mle.heartbeat = r.getSigned();
     mle.timestamp = par->getcurrtime();
+    if (!r.ok)
+      return 0;
+    Address memAddr = id_portToAddress(mle.id, mle.port);
 
     updateMember (mle);
 
     //JOINREP
-    size_t listSize;
-    char *ptr = serializeList (memberNode->memberList, &listSize);
-
-    size_t msgsize = sizeof(MessageHdr) + listSize + sizeof(size_t);
-    msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-    // create JOINREP message 
-    msg->msgType = JOINREP;
-    memcpy((char *)(msg+1), ptr, (sizeof(size_t) + listSize)*sizeof(char));
+    // create JOINREP message(s) with the whole list
+    vector<MsgBuf *> chunks;
+    if (par->PROTOCOL != PROTOCOL_SWIM)
+      sweepMembers ();
+    selectChanged (0);
+    buildList (JOINREP, chunks);
 
     // send JOINREP message to the new member
-    emulNet->ENsend(&memberNode->addr, &memAddr, (char *)msg, msgsize);
-
-    free(msg);
-    free(ptr);
+    for (unsigned int c = 0; c<chunks.size(); c++){
+      emulNet->ENsend(&memberNode->addr, &memAddr, chunks[c]);
+      chunks[c]->release();
+    }
   }
   else if (msg_recv->msgType == JOINREP){
-    vector<MemberListEntry> ml = deserializeList (data + sizeof(MessageHdr));
-    int numMembers = ml.size();
+    if (size <= (int)sizeof(MessageHdr) || data[sizeof(MessageHdr)] != WIRE_VERSION)
+      return 0;
 
-    addSelfToGroup();
-    for (int i=0; i<numMembers; i++){
-      updateMember (ml[i]);
-    }
+    // Any chunk of the reply gets us in
+    if (!memberNode->inGroup)
+      addSelfToGroup();
+    mergeList (data + sizeof(MessageHdr), size - sizeof(MessageHdr));
   }
   else if (msg_recv->msgType == HEARTBEAT && memberNode->inGroup){
-    vector<MemberListEntry> ml = deserializeList (data + sizeof(MessageHdr));
-    int numMembers = ml.size();
-
-    for (int i=0; i<numMembers; i++){
-      updateMember (ml[i]);
-    }
+    mergeList (data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+  }
+  else if ((msg_recv->msgType == PING || msg_recv->msgType == ACK || msg_recv->msgType == PINGREQ)
+           && memberNode->inGroup){
+    swimRecv (data, size);
   }
 
   return 1;
@@ -311,7 +348,7 @@ void MP1Node::nodeLoopOps() {
 	 * Your code goes here
 	 */
 
-  vector<MemberListEntry> &ml = memberNode->memberList;
+  MemberTable &ml = memberNode->memberList;
   int current_time = par->getcurrtime();
   
   //Update Heartbeat
@@ -320,30 +357,41 @@ void MP1Node::nodeLoopOps() {
   short port = portFromAddress(memberNode->addr);
 
   //First member of list is self
-  ml[0].setheartbeat(memberNode->heartbeat);
-  ml[0].settimestamp(current_time);
+  ml.setheartbeat(0, memberNode->heartbeat);
+  ml.settimestamp(0, current_time);
+  if (memberNode->heartbeat - ml.getpublished(0) >= par->DELTA_STEP)
+    ml.touch(0);
 
-  if (ml[0].getid() != id)
+  if (ml.getid(0) != id)
     printf ("Problem!\n");
   
   //Update Membership List
+  sweepMembers ();
   for (int i = 0; i<ml.size(); i++){
-    if (current_time - ml[i].gettimestamp() > TREMOVE){
+    if (ExpirySweep::test(&expireMask[0], i)){
 
       // printf ("removing: time: %d | host: id %d, port %d | guest: id %d, port %d "
       //         "hbt: %d, timestamp %d\n",
       //         par->getcurrtime(), id, port, ml[i].getid(),
       //         ml[i].getport(), ml[i].getheartbeat(), ml[i].gettimestamp());
 
-#ifdef DEBUGLOG
-      Address addr = id_portToAddress (ml[i].getid(), ml[i].getport());
-      log->logNodeRemove(&memberNode->addr, &addr);
-#endif
-      ml.erase (ml.begin() + i);
+      metrics->memberRemoved(idFromAddress(memberNode->addr), ml.getid(i));
+      if (Log::enabled<LOG_MEMBERSHIP>()){
+        Address addr = id_portToAddress (ml.getid(i), ml.getport(i));
+        log->logNodeRemove(&memberNode->addr, &addr);
+      }
+      // The last entry moves into slot i, so look at i again
+      int last = ml.size() - 1;
+      ExpirySweep::move(&expireMask[0], last, i);
+      ExpirySweep::move(&suspectMask[0], last, i);
+      ml.removeAt (i);
+      membershipChanged = true;
       i--;
     }
   }
 
+  checkIntroducer ();
+
   // if (memberNode->heartbeat == 600){
   //   printf ("Membership list of node with id: %d, port: %d\n", id, port);
   //   for(int i = 0; i<ml.size(); i++){
@@ -353,32 +401,71 @@ void MP1Node::nodeLoopOps() {
   // }
   
 
-  //HEARTBEAT (Propagate)
-  if (ml.size() > 1){
-    size_t listSize;
-    char *ptr = serializeList (ml, &listSize);
-
-    size_t msgsize = sizeof(MessageHdr) + listSize + sizeof(size_t);
-    MessageHdr* msg = (MessageHdr *) malloc(msgsize * sizeof(char));
+  int fanout = GOSSIPFANOUT;
+  if (par->GOSSIP_ADAPTIVE && !adaptGossip(&fanout))
+    return;
 
-    // create 
-    msg->msgType = HEARTBEAT;
-    memcpy((char *)(msg+1), ptr, (sizeof(size_t) + listSize)*sizeof(char));
+  //HEARTBEAT (Propagate)
+  // In delta mode each target gets the rows changed since the version last
+  // sent to it (all of them the first time), plus a full list every
+  // FULL_SYNC ticks (staggered by id) so that lost deltas are repaired (any
+  // round in the window of gossipInterval ticks does it in adaptive mode).
+  // (Buffer mode runs SWIM, see swimLoopOps.)
+  if (par->GOSSIP_MODE == GOSSIP_DELTA){
+    if (ml.size() > 1)
+      gossipDeltas (fanout, (current_time + id) % fullSync() < gossipInterval);
+  }
+  else if (ml.size() > 1){
+    // Built once and shared by all the gossip targets
+    vector<MsgBuf *> chunks;
+    if (par->GOSSIP_MODE == GOSSIP_SUBSET)
+      selectSubset ();
+    else
+      selectChanged (0);
+    buildList (HEARTBEAT, chunks);
 
-    // send to GOSSIPFANOUT randomly selected nodes
-    for (int i = 1; i<=GOSSIPFANOUT; i++){
-      int member_to_send = rand() % (ml.size()-1) + 1;
+    // send to fanout randomly selected nodes
+    for (int i = 1; i<=fanout; i++){
+      int member_to_send = rng.below(ml.size()-1) + 1;
       // printf ("sending to idx %d\n", member_to_send);
-      Address addr = id_portToAddress(ml[member_to_send].getid(), ml[member_to_send].getport());
-      emulNet->ENsend(&memberNode->addr, &addr, (char *)msg, msgsize);
+      Address addr = id_portToAddress(ml.getid(member_to_send), ml.getport(member_to_send));
+      for (unsigned int c = 0; c<chunks.size(); c++)
+        emulNet->ENsend(&memberNode->addr, &addr, chunks[c]);
     }
 
-    free(msg);
-    free(ptr);
+    for (unsigned int c = 0; c<chunks.size(); c++)
+      chunks[c]->release();
   }  
   return;
 }
 
+/**
+ * FUNCTION NAME: gossipDeltas
+ *
+ * DESCRIPTION: Send each of fanout random members the rows changed since the
+ * 				version last sent to it, or all rows when full is set
+ */
+void MP1Node::gossipDeltas (int fanout, bool full) {
+  MemberTable &ml = memberNode->memberList;
+
+  for (int i = 1; i<=fanout; i++){
+    int member_to_send = rng.below(ml.size()-1) + 1;
+    long since = full ? 0 : ml.getsent(member_to_send);
+    if (ml.getclock() <= since)
+      continue;
+    ml.setsent(member_to_send, ml.getclock());
+
+    vector<MsgBuf *> chunks;
+    selectChanged (since);
+    buildList (HEARTBEAT, chunks);
+    Address addr = id_portToAddress(ml.getid(member_to_send), ml.getport(member_to_send));
+    for (unsigned int c = 0; c<chunks.size(); c++){
+      emulNet->ENsend(&memberNode->addr, &addr, chunks[c]);
+      chunks[c]->release();
+    }
+  }
+}
+
 /**
  * FUNCTION NAME: isNullAddress
  *
@@ -423,84 +510,274 @@ void MP1Node::printAddress(Address *addr)
          addr->addr[3], *(short*)&addr->addr[4]) ;    
 }
 
-int mleSize(){
-  return sizeof(int) + sizeof(short) + 2*sizeof(long);
+/**
+ * FUNCTION NAME: suspectAfter
+ *
+ * DESCRIPTION: Age after which a member is gossiped as suspected. Delta mode
+ * 				publishes a heartbeat only every DELTA_STEP beats, so entries
+ * 				are that much older when they arrive.
+ */
+long MP1Node::suspectAfter () {
+  if (par->GOSSIP_MODE == GOSSIP_DELTA)
+    return TFAIL + par->DELTA_STEP - 1;
+  return TFAIL;
 }
 
-char* MP1Node::serializeList (vector<MemberListEntry> &memberList, size_t *listSize) {
-  int numMembers = memberList.size();
-  *listSize = mleSize() * numMembers;
-  char *ptr = (char *)malloc((*listSize + sizeof(size_t))* sizeof(char));
-  char *itr = ptr; 
-
-  memcpy((char *)(itr), listSize, sizeof(size_t));
-  itr += sizeof(size_t);
+/**
+ * FUNCTION NAME: fullSync
+ *
+ * DESCRIPTION: Ticks between the full lists of delta mode and between the
+ * 				requests for the introducer's list, at least one whatever
+ * 				FULL_SYNC was set to
+ */
+int MP1Node::fullSync () {
+  return max(1, par->FULL_SYNC);
+}
 
-  const long m1 = -1;
-  for(int i= 0; i<numMembers; i++){
-    memcpy(itr, &memberList[i].id, sizeof(int));
-    itr += sizeof(int);
-    memcpy(itr, &memberList[i].port, sizeof(short));
-    itr += sizeof(short);
-    if (par->getcurrtime() - memberList[i].gettimestamp() > TFAIL)
-      memcpy(itr, &m1, sizeof(long));
-    else
-      memcpy(itr, &memberList[i].heartbeat, sizeof(long));
-    itr += sizeof(long);
-    memcpy(itr, &memberList[i].timestamp, sizeof(long));
-    itr += sizeof(long);
+/**
+ * FUNCTION NAME: sweepMembers
+ *
+ * DESCRIPTION: Refresh suspectMask and expireMask from the timestamps of the
+ * 				membership table
+ */
+void MP1Node::sweepMembers () {
+  MemberTable &ml = memberNode->memberList;
+  unsigned int words = SWEEP_WORDS(ml.size()) + 1;
+  if (suspectMask.size() < words){
+    suspectMask.resize(words);
+    expireMask.resize(words);
   }
-  return ptr;
+  ExpirySweep::run(ml.timestampData(), ml.size(), par->getcurrtime(), suspectAfter(), TREMOVE,
+                   &suspectMask[0], &expireMask[0]);
 }
 
-vector<MemberListEntry> MP1Node::deserializeList (char *ptr){
-  char *itr = ptr;
-  size_t listSize;
-  memcpy (&listSize, (char *)(itr), sizeof(size_t));
-  itr += sizeof(size_t);
+/**
+ * FUNCTION NAME: entryBound
+ *
+ * DESCRIPTION: Upper bound of the encoded size of row i (its id delta is at
+ * 				most the id itself)
+ */
+int MP1Node::entryBound (MemberTable &memberList, const uint64_t *suspected, int i) {
+  long heartbeat = suspected && ExpirySweep::test(suspected, i) ? -1 : memberList.getheartbeat(i);
+  return WireWriter::varintSize((uint32_t)memberList.getid(i)) +
+    WireWriter::signedSize(memberList.getport(i)) +
+    WireWriter::varintSize(memberList.getincarnation(i)) + WireWriter::signedSize(heartbeat);
+}
+
+/**
+ * FUNCTION NAME: listBudget
+ *
+ * DESCRIPTION: Bytes of entries that fit in one message EmulNet accepts
+ */
+int MP1Node::listBudget () {
+  return par->MAX_MSG_SIZE - (int)sizeof(en_msg) - (int)sizeof(MessageHdr) - 1 - WIRE_LIST_HDR_MAX;
+}
 
-  int numMembers = listSize / mleSize();
-  vector<MemberListEntry> ml(numMembers);
+/**
+ * FUNCTION NAME: selectChanged
+ *
+ * DESCRIPTION: Put the rows changed after version since (all rows for 0)
+ * 				in order
+ */
+void MP1Node::selectChanged (long since) {
+  MemberTable &ml = memberNode->memberList;
+  order.clear();
+  for (int i = 0; i<ml.size(); i++)
+    if (ml.getversion(i) > since)
+      order.push_back(i);
+}
 
-  for (int i=0; i<numMembers; i++){
-    memcpy (&ml[i].id, itr, sizeof(int));
-    itr += sizeof(int);
-    memcpy (&ml[i].port, itr, sizeof(short));
-    itr += sizeof(short);
-    memcpy (&ml[i].heartbeat, itr, sizeof(long));
-    itr += sizeof(long);
-    memcpy (&ml[i].timestamp, itr, sizeof(long));
-    itr += sizeof(long);
+/**
+ * FUNCTION NAME: selectSubset
+ *
+ * DESCRIPTION: Put self and as many randomly picked rows as fit in one
+ * 				message in order
+ */
+void MP1Node::selectSubset () {
+  MemberTable &ml = memberNode->memberList;
+  const uint64_t *suspected = &suspectMask[0];
+  int budget = listBudget() - entryBound(ml, suspected, 0);
+
+  order.clear();
+  for (int i = 1; i<ml.size(); i++)
+    order.push_back(i);
+  // Partial Fisher-Yates shuffle, stopping once the budget is used up
+  int picked = 0;
+  for (; picked < (int)order.size(); picked++){
+    int j = picked + rng.below(order.size() - picked);
+    swap(order[picked], order[j]);
+    budget -= entryBound(ml, suspected, order[picked]);
+    if (budget < 0)
+      break;
+  }
+  order.resize(picked);
+  order.push_back(0);
+}
+
+/**
+ * FUNCTION NAME: buildList
+ *
+ * DESCRIPTION: Encode the rows in order as messages of type msgType and
+ * 				append them to chunks. Each message stays under MAX_MSG_SIZE;
+ * 				a long list is split into several self-contained chunks.
+ */
+void MP1Node::buildList (enum MsgTypes msgType, vector<MsgBuf *> &chunks) {
+  MemberTable &ml = memberNode->memberList;
+  const uint64_t *suspected = suspectMask.empty() ? NULL : &suspectMask[0];
+  int budget = listBudget();
+
+  sort(order.begin(), order.end(), [&ml](int a, int b){
+    if (ml.getid(a) != ml.getid(b))
+      return ml.getid(a) < ml.getid(b);
+    return ml.getport(a) < ml.getport(b);
+  });
+
+  // Cut order into runs that fit the budget
+  vector<int> starts(1, 0);
+  int used = 0;
+  for (int k = 0; k<(int)order.size(); k++){
+    int bytes = entryBound(ml, suspected, order[k]);
+    if (used + bytes > budget && k > starts.back()){
+      starts.push_back(k);
+      used = 0;
+    }
+    used += bytes;
+  }
+  starts.push_back(order.size());
+
+  int total = starts.size() - 1;
+  for (int seq = 0; seq<total; seq++){
+    int begin = starts[seq], end = starts[seq+1];
+    MsgBuf *buf = emulNet->ENalloc(sizeof(MessageHdr) + 1 + WIRE_LIST_HDR_MAX +
+                                   (end - begin) * (2*WIRE_VARINT32_MAX + 2*WIRE_VARINT64_MAX));
+    MessageHdr *msg = (MessageHdr *) buf->data();
+    msg->msgType = msgType;
+    buf->size = sizeof(MessageHdr) +
+      serializeList (ml, suspected, begin, end, seq, total, (char *)(msg+1));
+    chunks.push_back(buf);
+  }
+}
+
+/**
+ * FUNCTION NAME: serializeList
+ *
+ * DESCRIPTION: Encode chunk seq of total, made of the rows order[begin..end),
+ * 				at ptr and return its size. Members with their bit set in
+ * 				suspected (if not NULL) are sent with heartbeat -1. Timestamps are local
+ * 				and are not sent.
+ *
+ * 				Format (all varints, see Wire.h):
+ * 				  version, seq, total, count,
+ * 				  count x { id - previous id, port, incarnation, heartbeat }
+ * 				with the entries sorted by (id, port) so the id deltas stay
+ * 				small. Every chunk starts its deltas from 0, so it can be
+ * 				decoded on its own.
+ */
+size_t MP1Node::serializeList (MemberTable &memberList, const uint64_t *suspected,
+                               int begin, int end, int seq, int total, char *ptr) {
+  WireWriter w(ptr);
+
+  w.putByte(WIRE_VERSION);
+  w.putVarint(seq);
+  w.putVarint(total);
+  w.putVarint(end - begin);
+
+  const long *heartbeats = memberList.heartbeatData();
+  uint32_t prev = 0;
+  for(int k= begin; k<end; k++){
+    int i = order[k];
+    uint32_t id = (uint32_t)memberList.getid(i);
+    w.putVarint(id - prev);
+    prev = id;
+    w.putSigned(memberList.getport(i));
+    w.putVarint(memberList.getincarnation(i));
+    w.putSigned(suspected && ExpirySweep::test(suspected, i) ? -1 : heartbeats[i]);
   }
+  return w.size();
+}
+
+/**
+ * FUNCTION NAME: mergeList
+ *
+ * DESCRIPTION: Decode one chunk written by serializeList and merge each entry
+ * 				into the table as it is read. Merging keeps the larger
+ * 				(incarnation, heartbeat), so chunks need no buffering: they can be applied in
+ * 				any order, and a lost chunk loses only its own entries until
+ * 				the next round. Returns false if the payload is malformed;
+ * 				entries before the fault are kept.
+ */
+bool MP1Node::mergeList (char *ptr, int size){
+  WireReader r(ptr, size);
+  if (r.getByte() != WIRE_VERSION)
+    return false;
 
-  return ml;
-} 
+  uint64_t seq = r.getVarint();
+  uint64_t total = r.getVarint();
+  if (!r.ok || seq >= total)
+    return false;
 
+  uint64_t numMembers = r.getVarint();
+  uint32_t id = 0;
+  MemberListEntry mle;
+  for (uint64_t k = 0; k<numMembers && r.ok; k++){
+    id += (uint32_t)r.getVarint();
+    mle.id = (int)id;
+    mle.port = (short)r.getSigned();
+    mle.incarnation = (long)r.getVarint();
+    mle.heartbeat = r.getSigned();
+    if (r.ok)
+      updateMember (mle);
+  }
+  return r.ok;
+}
+
+/**
+ * FUNCTION NAME: updateMember
+ *
+ * DESCRIPTION: Merge one entry heard from the group. A larger incarnation
+ * 				means the member restarted: its entry is taken at once,
+ * 				whatever the heartbeat of the previous run was. A suspected
+ * 				entry (heartbeat -1) never adds nor refreshes a member.
+ */
 void MP1Node::updateMember (MemberListEntry mle){
-  vector<MemberListEntry> &ml = memberNode->memberList;
-  int id = mle.getid();
-  short port = mle.getport();
+  MemberTable &ml = memberNode->memberList;
   int current_time = par->getcurrtime();
 
-  for(int i = 0; i<ml.size(); i++){
-    if(ml[i].getid() == id && ml[i].getport() == port){
-      if (ml[i].getheartbeat() < mle.getheartbeat())
-      {
-        ml[i].settimestamp(current_time);
-        ml[i].setheartbeat(mle.getheartbeat());
-      }
+  if (par->PROTOCOL == PROTOCOL_SWIM){
+    mergeSwim (mle);
+    return;
+  }
+
+  int i = ml.find(mle.getid(), mle.getport());
+  if (i != -1){
+    if (mle.getheartbeat() == -1 || ml.getincarnation(i) > mle.getincarnation())
       return;
+    if (ml.getincarnation(i) < mle.getincarnation()){
+      ml.setincarnation(i, mle.getincarnation());
+      ml.settimestamp(i, current_time);
+      ml.setheartbeat(i, mle.getheartbeat());
+      ml.touch(i);
+    }
+    else if (ml.getheartbeat(i) < mle.getheartbeat())
+    {
+      ml.settimestamp(i, current_time);
+      ml.setheartbeat(i, mle.getheartbeat());
+      if (mle.getheartbeat() - ml.getpublished(i) >= par->DELTA_STEP)
+        ml.touch(i);
     }
+    return;
   }
 
   if (mle.getheartbeat() != -1){
   mle.settimestamp(par->getcurrtime());
-  ml.push_back(mle);
+  ml.add(mle);
+  membershipChanged = true;
 
-#ifdef DEBUGLOG
-  Address addr = id_portToAddress(mle.id, mle.port);
-  log->logNodeAdd(&memberNode->addr, &addr);
-#endif
+  metrics->memberAdded(idFromAddress(memberNode->addr));
+  if (Log::enabled<LOG_MEMBERSHIP>()){
+    Address addr = id_portToAddress(mle.id, mle.port);
+    log->logNodeAdd(&memberNode->addr, &addr);
+  }
   }
 }
 
@@ -509,8 +786,458 @@ void MP1Node::addSelfToGroup (){
   // Add itself to member list
   MemberListEntry mle(idFromAddress(memberNode->addr), portFromAddress(memberNode->addr),
                       memberNode->heartbeat, par->getcurrtime());
-  memberNode->memberList.push_back(mle);
-#ifdef DEBUGLOG
-  log->logNodeAdd(&memberNode->addr, &memberNode->addr);
-#endif
+  mle.setincarnation(memberNode->incarnation);
+  memberNode->myPos = memberNode->memberList.add(mle);
+  metrics->memberAdded(idFromAddress(memberNode->addr));
+  if (Log::enabled<LOG_MEMBERSHIP>())
+    log->logNodeAdd(&memberNode->addr, &memberNode->addr);
+}
+
+/**
+ * FUNCTION NAME: adaptGossip
+ *
+ * DESCRIPTION: Adaptive gossip (GOSSIP_ADAPTIVE): set the fanout to
+ * 				log10(N) + 1 for the current list (GOSSIPFANOUT at the size
+ * 				of the test cases) and say whether to gossip this tick.
+ * 				A member added or removed, or more members suspected than
+ * 				last tick (a sign of failures or of messages being lost),
+ * 				brings the interval back to one tick and doubles the fanout
+ * 				for the round. Every GOSSIP_STABLE ticks without any, the
+ * 				interval grows by one tick, up to GOSSIP_MAX_INTERVAL.
+ */
+bool MP1Node::adaptGossip (int *fanout){
+  MemberTable &ml = memberNode->memberList;
+  int current_time = par->getcurrtime();
+  int suspects = ExpirySweep::count(&suspectMask[0], ml.size());
+
+  bool burst = membershipChanged || suspects > 2*lastSuspects + 1 + ml.size() / 16;
+
+  *fanout = (int)ceil(log10((double)ml.size())) + 1;
+  if (burst){
+    gossipInterval = max(1, gossipInterval / 2);
+    stableSince = current_time;
+    *fanout *= 2;
+  }
+  else if (current_time - stableSince >= GOSSIP_STABLE && gossipInterval < GOSSIP_MAX_INTERVAL){
+    gossipInterval++;
+    stableSince = current_time;
+  }
+  membershipChanged = false;
+  lastSuspects = (3*lastSuspects + suspects) / 4;
+
+  if (!burst && current_time - lastGossip < gossipInterval)
+    return false;
+  lastGossip = current_time;
+  return true;
+}
+
+/**
+ * FUNCTION NAME: checkIntroducer
+ *
+ * DESCRIPTION: A node that lost the introducer from its list may be on the
+ * 				far side of a healed partition, which the protocol alone
+ * 				never reaches again: ask the introducer for its list, first
+ * 				at the node's FULL_SYNC slot, then twice as long apart each
+ * 				time. The introducer may as well have failed, so the node
+ * 				gives up after INTRO_RETRIES requests until it is back.
+ */
+void MP1Node::checkIntroducer (){
+  Address joinaddr = getJoinAddress();
+  int current_time = par->getcurrtime();
+
+  if (!memberNode->inGroup)
+    return;
+  if (hasMember(&joinaddr)){
+    introRetries = 0;
+    introNext = -1;
+    return;
+  }
+  if (introRetries >= INTRO_RETRIES)
+    return;
+  if (introNext < 0 ? (current_time + idFromAddress(memberNode->addr)) % fullSync() != 0 : current_time < introNext)
+    return;
+
+  introduceSelfToGroup(&joinaddr);
+  introNext = current_time + (int)min((long)fullSync() << introRetries, (long)par->RUN_LENGTH);
+  introRetries++;
+}
+
+/**
+ * FUNCTION NAME: hasMember
+ *
+ * DESCRIPTION: Whether addr is a member in this node's list (in SWIM mode,
+ * 				one not confirmed dead)
+ */
+bool MP1Node::hasMember (Address *addr){
+  MemberTable &ml = memberNode->memberList;
+  int i = ml.find(idFromAddress(*addr), portFromAddress(*addr));
+  if (i < 0)
+    return false;
+  return par->PROTOCOL != PROTOCOL_SWIM || ml.getheartbeat(i) != SWIM_DEAD;
+}
+
+/**
+ * FUNCTION NAME: swimRtt
+ *
+ * DESCRIPTION: Ticks to wait for the ack of a direct ping
+ */
+int MP1Node::swimRtt (){
+  return max(1, (int)ceil(2 * (par->LATENCY + par->LINK_SPREAD + par->JITTER)));
+}
+
+/**
+ * FUNCTION NAME: swimWindow
+ *
+ * DESCRIPTION: Ticks a suspicion lasts before it is confirmed:
+ * 				SWIM_LAMBDA * log2(N + 1). The dead are kept twice as long,
+ * 				so that late rumours of them being alive are ignored.
+ */
+int MP1Node::swimWindow (){
+  return (int)ceil(SWIM_LAMBDA * log2(memberNode->memberList.size() + 1.0));
+}
+
+/**
+ * FUNCTION NAME: swimLoopOps
+ *
+ * DESCRIPTION: One SWIM protocol period. Confirm the suspicions that were
+ * 				not refuted in time, then carry on with the probe of one
+ * 				member:
+ * 				- a direct PING, acked within swimRtt() ticks;
+ * 				- else a PINGREQ to SWIM_K other members, which ping the
+ * 				  target and relay its ack;
+ * 				- else, after 3 * swimRtt() ticks, suspect the target.
+ * 				The next probe starts as soon as one ends, with the members
+ * 				taken in a random order each round, so every member is
+ * 				probed once per round and the load per node stays constant
+ * 				whatever the size of the group. In buffer mode the changes
+ * 				are gossiped as well (see gossipBuffer).
+ */
+void MP1Node::swimLoopOps (){
+  MemberTable &ml = memberNode->memberList;
+  int current_time = par->getcurrtime();
+  int window = swimWindow();
+
+  // Confirm old suspicions, and forget the dead once no longer piggybacked
+  for (int i = 1; i<ml.size(); i++){
+    long age = current_time - ml.gettimestamp(i);
+    if (ml.getheartbeat(i) == SWIM_SUSPECT && age >= window){
+      ml.setheartbeat(i, SWIM_DEAD);
+      ml.settimestamp(i, current_time);
+      ml.touch(i);
+      metrics->memberRemoved(idFromAddress(memberNode->addr), ml.getid(i));
+      if (Log::enabled<LOG_MEMBERSHIP>()){
+        Address addr = id_portToAddress (ml.getid(i), ml.getport(i));
+        log->logNodeRemove(&memberNode->addr, &addr);
+      }
+    }
+    else if (ml.getheartbeat(i) == SWIM_DEAD && age >= 2*window){
+      ml.removeAt (i);
+      i--;
+    }
+  }
+
+  if (probing){
+    int age = current_time - probeStart;
+    int row = ml.find(probeId, probePort);
+    if (probeAcked || row < 0 || ml.getheartbeat(row) == SWIM_DEAD){
+      probing = false;
+    }
+    else if (age >= 3*swimRtt()){
+      if (ml.getheartbeat(row) == SWIM_ALIVE){
+        ml.setheartbeat(row, SWIM_SUSPECT);
+        ml.settimestamp(row, current_time);
+        ml.touch(row);
+      }
+      probing = false;
+    }
+    else if (age == swimRtt()){
+      // Ask SWIM_K random members, other than the target, to probe it
+      Address target = id_portToAddress(probeId, probePort);
+      for (int tries = 0, asked = 0; asked < par->SWIM_K && tries < 2*par->SWIM_K && ml.size() > 2; tries++){
+        int i = rng.below(ml.size()-1) + 1;
+        if (i == row || ml.getheartbeat(i) == SWIM_DEAD)
+          continue;
+        Address helper = id_portToAddress(ml.getid(i), ml.getport(i));
+        sendProbe (PINGREQ, &helper, probeSeq, &target, &memberNode->addr);
+        asked++;
+      }
+    }
+  }
+
+  if (!probing && nextProbe()){
+    probing = true;
+    probeAcked = false;
+    probeSeq++;
+    probeStart = current_time;
+    Address target = id_portToAddress(probeId, probePort);
+    sendProbe (PING, &target, probeSeq, &target, &memberNode->addr);
+  }
+
+  if (par->GOSSIP_MODE == GOSSIP_BUFFER)
+    gossipBuffer ();
+
+  checkIntroducer ();
+}
+
+/**
+ * FUNCTION NAME: gossipBuffer
+ *
+ * DESCRIPTION: Send the least sent changes to GOSSIPFANOUT random members,
+ * 				on top of those piggybacked on the probes. Nothing goes out
+ * 				when no change is left to spread: the probes, not the
+ * 				gossip, tell who is alive.
+ */
+void MP1Node::gossipBuffer (){
+  MemberTable &ml = memberNode->memberList;
+  if (ml.size() < 2)
+    return;
+
+  selectPiggyback (listBudget(), GOSSIPFANOUT);
+  if (order.empty())
+    return;
+  vector<MsgBuf *> chunks;
+  buildList (HEARTBEAT, chunks);
+
+  for (int i = 1; i<=GOSSIPFANOUT; i++){
+    int member_to_send = rng.below(ml.size()-1) + 1;
+    if (ml.getheartbeat(member_to_send) == SWIM_DEAD)
+      continue;
+    Address addr = id_portToAddress(ml.getid(member_to_send), ml.getport(member_to_send));
+    for (unsigned int c = 0; c<chunks.size(); c++)
+      emulNet->ENsend(&memberNode->addr, &addr, chunks[c]);
+  }
+
+  for (unsigned int c = 0; c<chunks.size(); c++)
+    chunks[c]->release();
+}
+
+/**
+ * FUNCTION NAME: nextProbe
+ *
+ * DESCRIPTION: Pick the next member to probe into probeId / probePort.
+ * 				Returns false if there is none.
+ */
+bool MP1Node::nextProbe (){
+  MemberTable &ml = memberNode->memberList;
+
+  for (int round = 0; round < 2; round++){
+    while (probeNext < probeOrder.size()){
+      pair<int, short> m = probeOrder[probeNext++];
+      int i = ml.find(m.first, m.second);
+      if (i > 0 && ml.getheartbeat(i) != SWIM_DEAD){
+        probeId = m.first;
+        probePort = m.second;
+        return true;
+      }
+    }
+    // Start a new round over the current members, shuffled
+    probeOrder.clear();
+    probeNext = 0;
+    for (int i = 1; i<ml.size(); i++)
+      if (ml.getheartbeat(i) != SWIM_DEAD)
+        probeOrder.push_back(make_pair(ml.getid(i), ml.getport(i)));
+    for (int i = (int)probeOrder.size() - 1; i > 0; i--)
+      swap(probeOrder[i], probeOrder[rng.below(i + 1)]);
+  }
+  return false;
+}
+
+/**
+ * FUNCTION NAME: sendProbe
+ *
+ * DESCRIPTION: Send a SWIM message to to, about the probe seq of target
+ * 				started by origin, with the least sent state changes
+ * 				piggybacked (see selectPiggyback).
+ *
+ * 				Format: MessageHdr, then (varints, see Wire.h)
+ * 				  version, seq, sender id, sender port, target id,
+ * 				  target port, origin id, origin port,
+ * 				followed by one serializeList chunk.
+ */
+void MP1Node::sendProbe (enum MsgTypes msgType, Address *to, int seq, Address *target, Address *origin){
+  MemberTable &ml = memberNode->memberList;
+  int probeHdr = 1 + 7*WIRE_VARINT32_MAX;
+
+  selectPiggyback (listBudget() - probeHdr, 1);
+  sort(order.begin(), order.end(), [&ml](int a, int b){
+    if (ml.getid(a) != ml.getid(b))
+      return ml.getid(a) < ml.getid(b);
+    return ml.getport(a) < ml.getport(b);
+  });
+
+  MsgBuf *buf = emulNet->ENalloc(sizeof(MessageHdr) + probeHdr + 1 + WIRE_LIST_HDR_MAX +
+                                 order.size() * (2*WIRE_VARINT32_MAX + 2*WIRE_VARINT64_MAX));
+  MessageHdr *msg = (MessageHdr *) buf->data();
+  msg->msgType = msgType;
+  WireWriter w((char *)(msg+1));
+  w.putByte(WIRE_VERSION);
+  w.putVarint((uint32_t)seq);
+  w.putVarint((uint32_t)idFromAddress(memberNode->addr));
+  w.putSigned(portFromAddress(memberNode->addr));
+  w.putVarint((uint32_t)idFromAddress(*target));
+  w.putSigned(portFromAddress(*target));
+  w.putVarint((uint32_t)idFromAddress(*origin));
+  w.putSigned(portFromAddress(*origin));
+  buf->size = sizeof(MessageHdr) + w.size() +
+    serializeList (ml, NULL, 0, order.size(), 0, 1, w.ptr);
+
+  emulNet->ENsend(&memberNode->addr, to, buf);
+  buf->release();
+}
+
+/**
+ * FUNCTION NAME: piggybackLimit
+ *
+ * DESCRIPTION: Messages a change is carried on before it is retired from
+ * 				the dissemination buffer: PIGGYBACK_LAMBDA * log2(N + 1)
+ */
+int MP1Node::piggybackLimit (){
+  return (int)ceil(PIGGYBACK_LAMBDA * log2(memberNode->memberList.size() + 1.0));
+}
+
+/**
+ * FUNCTION NAME: selectPiggyback
+ *
+ * DESCRIPTION: Put in order the rows of the dissemination buffer, the rows
+ * 				carried on fewer than piggybackLimit() messages since they
+ * 				last changed, least sent first, as many as fit in budget
+ * 				bytes. They are counted as sent on copies messages. A change touches its row (see
+ * 				MemberTable::touch), which puts it back in the buffer.
+ */
+void MP1Node::selectPiggyback (int budget, int copies){
+  MemberTable &ml = memberNode->memberList;
+  const uint64_t *suspected = suspectMask.empty() ? NULL : &suspectMask[0];
+  int limit = piggybackLimit();
+
+  // Least sent first: counting sort on the transmit counts
+  vector<int> &first = piggybackCounts;
+  first.assign(limit + 1, 0);
+  for (int i = 0; i<ml.size(); i++)
+    if (ml.gettransmits(i) < limit)
+      first[ml.gettransmits(i) + 1]++;
+  for (int t = 1; t<=limit; t++)
+    first[t] += first[t-1];
+  order.resize(first[limit]);
+  for (int i = 0; i<ml.size(); i++)
+    if (ml.gettransmits(i) < limit)
+      order[first[ml.gettransmits(i)]++] = i;
+
+  unsigned int k = 0;
+  for (; k<order.size(); k++){
+    budget -= entryBound(ml, suspected, order[k]);
+    if (budget < 0)
+      break;
+    ml.addtransmits(order[k], copies);
+  }
+  order.resize(k);
+}
+
+/**
+ * FUNCTION NAME: swimRecv
+ *
+ * DESCRIPTION: Handle a PING, ACK or PINGREQ written by sendProbe: merge
+ * 				the piggybacked changes, then
+ * 				- PING: ack to the sender;
+ * 				- PINGREQ: ping the target on behalf of the origin;
+ * 				- ACK: end our probe if we started it, else relay it to the
+ * 				  origin.
+ */
+void MP1Node::swimRecv (char *data, int size){
+  MessageHdr *msg = (MessageHdr *) data;
+  WireReader r(data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+  if (r.getByte() != WIRE_VERSION)
+    return;
+
+  int seq = (int)r.getVarint();
+  int id = (int)r.getVarint();
+  Address sender = id_portToAddress(id, (short)r.getSigned());
+  id = (int)r.getVarint();
+  Address target = id_portToAddress(id, (short)r.getSigned());
+  id = (int)r.getVarint();
+  Address origin = id_portToAddress(id, (short)r.getSigned());
+  if (!r.ok || !mergeList ((char *)r.ptr, r.end - r.ptr))
+    return;
+
+  if (msg->msgType == PING){
+    sendProbe (ACK, &sender, seq, &memberNode->addr, &origin);
+  }
+  else if (msg->msgType == PINGREQ){
+    sendProbe (PING, &target, seq, &target, &origin);
+  }
+  else if (0 != memcmp(origin.addr, memberNode->addr.addr, sizeof(origin.addr))){
+    sendProbe (ACK, &origin, seq, &target, &origin);
+  }
+  else if (probing && seq == probeSeq && idFromAddress(target) == probeId && portFromAddress(target) == probePort){
+    probeAcked = true;
+  }
+}
+
+/**
+ * FUNCTION NAME: mergeSwim
+ *
+ * DESCRIPTION: SWIM version of updateMember; the heartbeat of mle holds
+ * 				its state. For the same incarnation dead overrides suspect,
+ * 				which overrides alive; a larger incarnation overrides both
+ * 				alive and suspect, and only an alive one brings a dead
+ * 				member back (a restart). A node that hears itself suspected
+ * 				or dead refutes it with a new incarnation.
+ */
+void MP1Node::mergeSwim (MemberListEntry mle){
+  MemberTable &ml = memberNode->memberList;
+  int current_time = par->getcurrtime();
+  long state = mle.getheartbeat();
+
+  if (mle.getid() == idFromAddress(memberNode->addr) && mle.getport() == portFromAddress(memberNode->addr)){
+    if (state != SWIM_ALIVE && mle.getincarnation() >= memberNode->incarnation){
+      memberNode->incarnation = mle.getincarnation() + 1;
+      ml.setincarnation(0, memberNode->incarnation);
+      ml.settimestamp(0, current_time);
+      ml.touch(0);
+    }
+    return;
+  }
+
+  int i = ml.find(mle.getid(), mle.getport());
+  if (i == -1){
+    if (state != SWIM_DEAD){
+      mle.settimestamp(current_time);
+      ml.add(mle);
+      metrics->memberAdded(idFromAddress(memberNode->addr));
+      if (Log::enabled<LOG_MEMBERSHIP>()){
+        Address addr = id_portToAddress(mle.id, mle.port);
+        log->logNodeAdd(&memberNode->addr, &addr);
+      }
+    }
+    return;
+  }
+
+  long inc = ml.getincarnation(i);
+  long current = ml.getheartbeat(i);
+  bool take;
+  if (current == SWIM_DEAD)
+    take = state == SWIM_ALIVE && mle.getincarnation() > inc;
+  else if (state == SWIM_ALIVE)
+    take = mle.getincarnation() > inc;
+  else if (state == SWIM_SUSPECT)
+    take = mle.getincarnation() > inc || (mle.getincarnation() == inc && current == SWIM_ALIVE);
+  else
+    take = mle.getincarnation() >= inc;
+  if (!take)
+    return;
+
+  ml.setincarnation(i, mle.getincarnation());
+  ml.setheartbeat(i, state);
+  ml.settimestamp(i, current_time);
+  ml.touch(i);
+  if (current == SWIM_DEAD)
+    metrics->memberAdded(idFromAddress(memberNode->addr));
+  else if (state == SWIM_DEAD)
+    metrics->memberRemoved(idFromAddress(memberNode->addr), mle.getid());
+  if (Log::enabled<LOG_MEMBERSHIP>() && (current == SWIM_DEAD || state == SWIM_DEAD)){
+    Address addr = id_portToAddress(mle.id, mle.port);
+    if (current == SWIM_DEAD)
+      log->logNodeAdd(&memberNode->addr, &addr);
+    else
+      log->logNodeRemove(&memberNode->addr, &addr);
+  }
 }
@@ -14,6 +14,11 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "MsgBuf.h"
+#include "Sweep.h"
+#include "Wire.h"
+#include "Random.h"
+#include "Metrics.h"
 
 /**
  * Macros
@@ -21,6 +26,21 @@
 #define TREMOVE 20
 #define TFAIL 5
 #define GOSSIPFANOUT 2
+// Adaptive gossip: the interval grows by one tick every GOSSIP_STABLE quiet
+// ticks, up to GOSSIP_MAX_INTERVAL
+#define GOSSIP_STABLE 5
+#define GOSSIP_MAX_INTERVAL 4
+// SWIM suspicions last SWIM_LAMBDA * log2(N + 1) ticks
+#define SWIM_LAMBDA 3
+// SWIM state of a member, kept in its heartbeat in SWIM mode
+#define SWIM_ALIVE 0
+#define SWIM_SUSPECT -1
+#define SWIM_DEAD -2
+// A change is piggybacked on PIGGYBACK_LAMBDA * log2(N + 1) messages
+#define PIGGYBACK_LAMBDA 3
+// A node that lost the introducer asks it for its list at most INTRO_RETRIES
+// times, FULL_SYNC ticks apart and then twice as long each time
+#define INTRO_RETRIES 8
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -33,6 +53,9 @@ enum MsgTypes{
     JOINREQ,
     JOINREP,
     HEARTBEAT,
+    PING,
+    ACK,
+    PINGREQ,
     DUMMYLASTMSGTYPE
 };
 
@@ -54,12 +77,43 @@ class MP1Node {
 private:
 	EmulNet *emulNet;
 	Log *log;
+	Metrics *metrics;
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
+	// Members older than TFAIL / TREMOVE, refreshed by sweepMembers()
+	vector<uint64_t> suspectMask;
+	vector<uint64_t> expireMask;
+	// Scratch row order used by serializeList
+	vector<int> order;
+	// Scratch counts of selectPiggyback
+	vector<int> piggybackCounts;
+	// Random stream of this node
+	Random rng;
+	// Adaptive gossip: ticks between rounds, tick of the last round and of
+	// the last change of interval, suspects seen at the last tick, and
+	// whether members were added or removed since
+	int gossipInterval;
+	int lastGossip;
+	int stableSince;
+	int lastSuspects;
+	bool membershipChanged;
+	// Requests sent to the introducer since this node lost it, and the
+	// tick of the next one (-1 before the first)
+	int introRetries;
+	int introNext;
+	// SWIM probe in progress, and the members left to probe this round
+	bool probing;
+	bool probeAcked;
+	int probeSeq;
+	int probeStart;
+	int probeId;
+	short probePort;
+	vector<pair<int, short> > probeOrder;
+	unsigned int probeNext;
 
 public:
-	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+	MP1Node(Member *, Params *, EmulNet *, Log *, Address *, Metrics *);
 	Member * getMemberNode() {
 		return memberNode;
 	}
@@ -77,10 +131,32 @@ public:
 	Address getJoinAddress();
 	void initMemberListTable(Member *memberNode);
 	void printAddress(Address *addr);
-  char* serializeList (vector<MemberListEntry> &, size_t *);
-  vector<MemberListEntry> deserializeList (char *);
+  long suspectAfter ();
+  int fullSync ();
+  void sweepMembers ();
+  int entryBound (MemberTable &, const uint64_t *, int);
+  int listBudget ();
+  void selectChanged (long);
+  void gossipDeltas (int, bool);
+  void selectSubset ();
+  void buildList (enum MsgTypes, vector<MsgBuf *> &);
+  size_t serializeList (MemberTable &, const uint64_t *, int, int, int, int, char *);
+  bool mergeList (char *, int);
   void updateMember (MemberListEntry);
   void addSelfToGroup ();
+  bool adaptGossip (int *);
+  void checkIntroducer ();
+  bool hasMember (Address *);
+  int swimRtt ();
+  int swimWindow ();
+  void swimLoopOps ();
+  void gossipBuffer ();
+  void swimRecv (char *, int);
+  void mergeSwim (MemberListEntry);
+  int piggybackLimit ();
+  void selectPiggyback (int, int);
+  void sendProbe (enum MsgTypes, Address *, int, Address *, Address *);
+  bool nextProbe ();
 	virtual ~MP1Node();
 };
 
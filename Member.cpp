@@ -40,12 +40,12 @@ bool Address::operator ==(const Address& anotherAddress) {
 /**
  * Constructor
  */
-MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp) {}
+MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp), incarnation(0) {}
 
 /**
  * Constuctor
  */
-MemberListEntry::MemberListEntry(int id, short port): id(id), port(port) {}
+MemberListEntry::MemberListEntry(int id, short port): id(id), port(port), incarnation(0) {}
 
 /**
  * Copy constructor
@@ -55,6 +55,7 @@ MemberListEntry::MemberListEntry(const MemberListEntry &anotherMLE) {
 	this->id = anotherMLE.id;
 	this->port = anotherMLE.port;
 	this->timestamp = anotherMLE.timestamp;
+	this->incarnation = anotherMLE.incarnation;
 }
 
 /**
@@ -66,6 +67,7 @@ MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE)
 	swap(id, temp.id);
 	swap(port, temp.port);
 	swap(timestamp, temp.timestamp);
+	swap(incarnation, temp.incarnation);
 	return *this;
 }
 
@@ -105,6 +107,15 @@ long MemberListEntry::gettimestamp() {
 	return timestamp;
 }
 
+/**
+ * FUNCTION NAME: getincarnation
+ *
+ * DESCRIPTION: getter
+ */
+long MemberListEntry::getincarnation() {
+	return incarnation;
+}
+
 /**
  * FUNCTION NAME: setid
  *
@@ -141,6 +152,184 @@ void MemberListEntry::settimestamp(long timestamp) {
 	this->timestamp = timestamp;
 }
 
+/**
+ * FUNCTION NAME: setincarnation
+ *
+ * DESCRIPTION: setter
+ */
+void MemberListEntry::setincarnation(long incarnation) {
+	this->incarnation = incarnation;
+}
+
+/**
+ * FUNCTION NAME: hash
+ *
+ * DESCRIPTION: Hash of a member key
+ */
+unsigned int MemberTable::hash(int id, short port) {
+	unsigned int h = (unsigned int)id * 0x9E3779B1u;
+	h ^= (unsigned short)port * 0x85EBCA6Bu;
+	return h ^ (h >> 16);
+}
+
+/**
+ * FUNCTION NAME: findSlot
+ *
+ * DESCRIPTION: Return the slot holding (id, port), or the empty slot that ends
+ * 				its probe sequence
+ */
+int MemberTable::findSlot(int id, short port) {
+	unsigned int mask = slots.size() - 1;
+	unsigned int s = hash(id, port) & mask;
+	while ( slots[s] != -1 ) {
+		if ( ids[slots[s]] == id && ports[slots[s]] == port ) {
+			break;
+		}
+		s = (s + 1) & mask;
+	}
+	return s;
+}
+
+/**
+ * FUNCTION NAME: rehash
+ *
+ * DESCRIPTION: Rebuild the index with nslots slots (a power of two)
+ */
+void MemberTable::rehash(unsigned int nslots) {
+	slots.assign(nslots, -1);
+	for ( unsigned int i = 0; i < ids.size(); i++ ) {
+		slots[findSlot(ids[i], ports[i])] = i;
+	}
+}
+
+/**
+ * FUNCTION NAME: entry
+ *
+ * DESCRIPTION: Return row i as a MemberListEntry
+ */
+MemberListEntry MemberTable::entry(int i) {
+	MemberListEntry mle(ids[i], ports[i], heartbeats[i], timestamps[i]);
+	mle.setincarnation(incarnations[i]);
+	return mle;
+}
+
+/**
+ * FUNCTION NAME: toList
+ *
+ * DESCRIPTION: Return a copy of the table as a vector of MemberListEntry
+ */
+vector<MemberListEntry> MemberTable::toList() {
+	vector<MemberListEntry> list;
+	list.reserve(ids.size());
+	for ( unsigned int i = 0; i < ids.size(); i++ ) {
+		list.push_back(entry(i));
+	}
+	return list;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Return the row of (id, port), -1 if absent
+ */
+int MemberTable::find(int id, short port) {
+	if ( slots.empty() ) {
+		return -1;
+	}
+	return slots[findSlot(id, port)];
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Append an entry whose key is not in the table yet and return
+ * 				its row. The new row counts as changed.
+ */
+int MemberTable::add(const MemberListEntry &mle) {
+	// Keep the load factor at or below one half
+	if ( 2 * (ids.size() + 1) > slots.size() ) {
+		rehash(slots.empty() ? 16 : 2 * slots.size());
+	}
+	ids.push_back(mle.id);
+	ports.push_back(mle.port);
+	incarnations.push_back(mle.incarnation);
+	heartbeats.push_back(mle.heartbeat);
+	timestamps.push_back(mle.timestamp);
+	versions.push_back(0);
+	published.push_back(0);
+	transmits.push_back(0);
+	sent.push_back(0);
+	int i = ids.size() - 1;
+	slots[findSlot(mle.id, mle.port)] = i;
+	touch(i);
+	return i;
+}
+
+/**
+ * FUNCTION NAME: removeAt
+ *
+ * DESCRIPTION: Remove row i. The last row takes its place.
+ */
+void MemberTable::removeAt(int i) {
+	unsigned int mask = slots.size() - 1;
+	unsigned int hole = findSlot(ids[i], ports[i]);
+	int last = ids.size() - 1;
+
+	// Backward shift deletion: pull later members of the probe run into the
+	// hole so that lookups never stop early
+	slots[hole] = -1;
+	unsigned int s = (hole + 1) & mask;
+	while ( slots[s] != -1 ) {
+		unsigned int home = hash(ids[slots[s]], ports[slots[s]]) & mask;
+		if ( ((s - home) & mask) >= ((s - hole) & mask) ) {
+			slots[hole] = slots[s];
+			slots[s] = -1;
+			hole = s;
+		}
+		s = (s + 1) & mask;
+	}
+
+	if ( i != last ) {
+		slots[findSlot(ids[last], ports[last])] = i;
+		ids[i] = ids[last];
+		ports[i] = ports[last];
+		incarnations[i] = incarnations[last];
+		heartbeats[i] = heartbeats[last];
+		timestamps[i] = timestamps[last];
+		versions[i] = versions[last];
+		published[i] = published[last];
+		transmits[i] = transmits[last];
+		sent[i] = sent[last];
+	}
+	ids.pop_back();
+	ports.pop_back();
+	incarnations.pop_back();
+	heartbeats.pop_back();
+	timestamps.pop_back();
+	versions.pop_back();
+	published.pop_back();
+	transmits.pop_back();
+	sent.pop_back();
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Remove all entries
+ */
+void MemberTable::clear() {
+	ids.clear();
+	ports.clear();
+	incarnations.clear();
+	heartbeats.clear();
+	timestamps.clear();
+	versions.clear();
+	published.clear();
+	transmits.clear();
+	sent.clear();
+	slots.clear();
+}
+
 /**
  * Copy Constructor
  */
@@ -151,6 +340,7 @@ Member::Member(const Member &anotherMember) {
 	this->bFailed = anotherMember.bFailed;
 	this->nnb = anotherMember.nnb;
 	this->heartbeat = anotherMember.heartbeat;
+	this->incarnation = anotherMember.incarnation;
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
@@ -168,6 +358,7 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->bFailed = anotherMember.bFailed;
 	this->nnb = anotherMember.nnb;
 	this->heartbeat = anotherMember.heartbeat;
+	this->incarnation = anotherMember.incarnation;
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
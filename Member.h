@@ -75,19 +75,138 @@ public:
 	short port;
 	long heartbeat;
 	long timestamp;
+	// Number of times the member has started; a larger incarnation
+	// supersedes any heartbeat of a smaller one
+	long incarnation;
 	MemberListEntry(int id, short port, long heartbeat, long timestamp);
 	MemberListEntry(int id, short port);
-	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0) {}
+	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0), incarnation(0) {}
 	MemberListEntry(const MemberListEntry &anotherMLE);
 	MemberListEntry& operator =(const MemberListEntry &anotherMLE);
 	int getid();
 	short getport();
 	long getheartbeat();
 	long gettimestamp();
+	long getincarnation();
 	void setid(int id);
 	void setport(short port);
 	void setheartbeat(long hearbeat);
 	void settimestamp(long timestamp);
+	void setincarnation(long incarnation);
+};
+
+/**
+ * CLASS NAME: MemberTable
+ *
+ * DESCRIPTION: Membership list stored as a structure of arrays: ids, ports,
+ * 				incarnations, heartbeats and timestamps each live in their own contiguous
+ * 				array, so the periodic sweeps over timestamps and heartbeats
+ * 				touch only the bytes they need. entry() gives the classic
+ * 				MemberListEntry view of a row.
+ *
+ * 				Each row also carries the version at which it last changed,
+ * 				so delta gossip can pick the rows changed since a round,
+ * 				the version last sent to that member, so delta gossip can
+ * 				send each peer what it has not been sent yet, and how many
+ * 				messages carried that change, for the dissemination buffer.
+ *
+ * 				An open addressing (linear probing) hash index on (id, port)
+ * 				finds a member in O(1). Removal moves the last row into the
+ * 				freed position.
+ */
+class MemberTable {
+private:
+	vector<int> ids;
+	vector<short> ports;
+	vector<long> incarnations;
+	vector<long> heartbeats;
+	vector<long> timestamps;
+	// Value of clock when the row last changed, and its heartbeat then
+	vector<long> versions;
+	vector<long> published;
+	// Messages that carried the row since it last changed
+	vector<int> transmits;
+	// Value of clock when the changed rows were last sent to the member
+	vector<long> sent;
+	long clock;
+	// Hash slots holding a row number, -1 when empty
+	vector<int> slots;
+	static unsigned int hash(int id, short port);
+	int findSlot(int id, short port);
+	void rehash(unsigned int nslots);
+public:
+	MemberTable(): clock(0) {}
+	int size() {
+		return ids.size();
+	}
+	bool empty() {
+		return ids.empty();
+	}
+	int getid(int i) {
+		return ids[i];
+	}
+	short getport(int i) {
+		return ports[i];
+	}
+	long getincarnation(int i) {
+		return incarnations[i];
+	}
+	long getheartbeat(int i) {
+		return heartbeats[i];
+	}
+	long gettimestamp(int i) {
+		return timestamps[i];
+	}
+	void setincarnation(int i, long incarnation) {
+		incarnations[i] = incarnation;
+	}
+	void setheartbeat(int i, long heartbeat) {
+		heartbeats[i] = heartbeat;
+	}
+	void settimestamp(int i, long timestamp) {
+		timestamps[i] = timestamp;
+	}
+	long getversion(int i) {
+		return versions[i];
+	}
+	long getpublished(int i) {
+		return published[i];
+	}
+	int gettransmits(int i) {
+		return transmits[i];
+	}
+	void addtransmits(int i, int n) {
+		transmits[i] += n;
+	}
+	long getsent(int i) {
+		return sent[i];
+	}
+	void setsent(int i, long version) {
+		sent[i] = version;
+	}
+	// Version of the latest change in the table
+	long getclock() {
+		return clock;
+	}
+	// Record a change of row i worth gossiping
+	void touch(int i) {
+		versions[i] = ++clock;
+		published[i] = heartbeats[i];
+		transmits[i] = 0;
+	}
+	// Column views, valid until the table is next modified
+	const long *heartbeatData() {
+		return heartbeats.data();
+	}
+	const long *timestampData() {
+		return timestamps.data();
+	}
+	MemberListEntry entry(int i);
+	vector<MemberListEntry> toList();
+	int find(int id, short port);
+	int add(const MemberListEntry &mle);
+	void removeAt(int i);
+	void clear();
 };
 
 /**
@@ -110,20 +229,23 @@ public:
 	int nnb;
 	// the node's own heartbeat
 	long heartbeat;
+	// number of times this member has started; kept across restarts, as
+	// if on stable storage
+	long incarnation;
 	// counter for next ping
 	int pingCounter;
 	// counter for ping timeout
 	int timeOutCounter;
 	// Membership table
-	vector<MemberListEntry> memberList;
+	MemberTable memberList;
 	// My position in the membership table
-	vector<MemberListEntry>::iterator myPos;
+	int myPos;
 	// Queue for failure detection messages
 	queue<q_elt> mp1q;
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), incarnation(0), pingCounter(0), timeOutCounter(0), myPos(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
@@ -0,0 +1,308 @@
+/**********************************
+ * FILE NAME: Metrics.cpp
+ *
+ * DESCRIPTION: Definition of the metrics registry of a run
+ **********************************/
+
+#include "Metrics.h"
+
+// Names of the dropReasons in the output
+static const char *dropNames[DROP_REASONS] = { "noroute", "buffull", "oversize", "partition", "link", "random", "queue", "down" };
+
+/**
+ * Constructor
+ */
+Metrics::Metrics(): falseRemovals(0), groupJoinedAt(-1), heals(0), reconverged(0), reconvergeMax(0), wallSeconds(0), peakRssKb(0) {}
+
+/**
+ * FUNCTION NAME: init
+ *
+ * DESCRIPTION: Size the registry for node ids 1 .. numNodes
+ */
+void Metrics::init(int numNodes) {
+	nodes.clear();
+	nodes.resize(numNodes + 1);
+	failures.clear();
+	falseRemovals = 0;
+	groupJoinedAt = -1;
+	heals = reconverged = reconvergeMax = 0;
+}
+
+/**
+ * FUNCTION NAME: nodeStarted
+ *
+ * DESCRIPTION: Node id (re)started at time with an empty membership list
+ */
+void Metrics::nodeStarted(int id, int time) {
+	NodeMetrics &node = nodes[id];
+	node.startedAt = time;
+	node.fullAt = -1;
+	node.members = 0;
+	node.removed.clear();
+}
+
+/**
+ * FUNCTION NAME: memberAdded
+ *
+ * DESCRIPTION: Node id added a member to its list
+ */
+void Metrics::memberAdded(int id) {
+	nodes[id].members++;
+}
+
+/**
+ * FUNCTION NAME: memberRemoved
+ *
+ * DESCRIPTION: Node id dropped subject from its list
+ */
+void Metrics::memberRemoved(int id, int subject) {
+	nodes[id].members--;
+	nodes[id].removed.push_back(subject);
+}
+
+/**
+ * FUNCTION NAME: tick
+ *
+ * DESCRIPTION: Fold in what the nodes reported while running at time. A
+ * 				removal of a failed node is a detection, of a live one a
+ * 				false removal. A node is fully joined the first tick its
+ * 				list holds as many members as there are live nodes, so
+ * 				the failed ones are not waited for.
+ */
+void Metrics::tick(int time) {
+	int started = 0, live = 0, full = 0;
+	unsigned int id, k;
+
+	for ( id = 1; id < nodes.size(); id++ ) {
+		NodeMetrics &node = nodes[id];
+		for ( k = 0; k < node.removed.size(); k++ ) {
+			if ( node.removed[k] <= 0 || node.removed[k] >= (int)nodes.size() ) {
+				continue;
+			}
+			NodeMetrics &subject = nodes[node.removed[k]];
+			if ( subject.failure >= 0 ) {
+				FailureRecord &f = failures[subject.failure];
+				if ( f.firstDetect < 0 ) {
+					f.firstDetect = time;
+				}
+			}
+			else if ( !subject.failed ) {
+				falseRemovals++;
+			}
+		}
+		node.removed.clear();
+		started += node.startedAt >= 0;
+		live += node.startedAt >= 0 && !node.failed;
+	}
+	for ( id = 1; id < nodes.size(); id++ ) {
+		NodeMetrics &node = nodes[id];
+		if ( node.startedAt < 0 || node.failed ) {
+			continue;
+		}
+		if ( node.fullAt < 0 && node.members >= live ) {
+			node.fullAt = time;
+		}
+		full += node.fullAt >= 0;
+	}
+	if ( groupJoinedAt < 0 && started == (int)nodes.size() - 1 && full == live ) {
+		groupJoinedAt = time;
+	}
+}
+
+/**
+ * FUNCTION NAME: nodeFailed
+ *
+ * DESCRIPTION: Node id failed at time. Only the failures of nodes in the
+ * 				group are waited on for detection.
+ */
+void Metrics::nodeFailed(int id, int time, bool inGroup) {
+	NodeMetrics &node = nodes[id];
+	if ( node.failed ) {
+		return;
+	}
+	node.failed = true;
+	if ( inGroup ) {
+		FailureRecord f = { id, time, -1, -1, false };
+		node.failure = failures.size();
+		failures.push_back(f);
+	}
+}
+
+/**
+ * FUNCTION NAME: nodeRecovered
+ *
+ * DESCRIPTION: Node id came back; removals of it are false again
+ */
+void Metrics::nodeRecovered(int id) {
+	NodeMetrics &node = nodes[id];
+	if ( node.failure >= 0 && failures[node.failure].lastDetect < 0 ) {
+		failures[node.failure].recovered = true;
+	}
+	node.failed = false;
+	node.failure = -1;
+}
+
+/**
+ * FUNCTION NAME: failureCleared
+ *
+ * DESCRIPTION: No live node lists the failed node id any more
+ */
+void Metrics::failureCleared(int id, int time) {
+	NodeMetrics &node = nodes[id];
+	if ( node.failure < 0 ) {
+		return;
+	}
+	FailureRecord &f = failures[node.failure];
+	if ( f.firstDetect < 0 ) {
+		f.firstDetect = time;
+	}
+	f.lastDetect = time;
+}
+
+/**
+ * FUNCTION NAME: reconvergedAfter
+ *
+ * DESCRIPTION: The group reconverged ticks after the last heal
+ */
+void Metrics::reconvergedAfter(int ticks) {
+	reconverged++;
+	reconvergeMax = max(reconvergeMax, ticks);
+}
+
+/**
+ * FUNCTION NAME: runCost
+ *
+ * DESCRIPTION: Wall time the run took and the peak resident size of the
+ * 				process, in KB
+ */
+void Metrics::runCost(double seconds, long rssKb) {
+	wallSeconds = seconds;
+	peakRssKb = rssKb;
+}
+
+/**
+ * FUNCTION NAME: getDetected
+ *
+ * DESCRIPTION: Number of failures every live node detected, and their mean
+ * 				ticks to the first and to the last detection
+ */
+int Metrics::getDetected(double *firstMean, double *lastMean) {
+	long firstSum = 0, lastSum = 0;
+	int detected = 0;
+
+	for ( unsigned int k = 0; k < failures.size(); k++ ) {
+		if ( failures[k].lastDetect >= 0 ) {
+			firstSum += failures[k].firstDetect - failures[k].failedAt;
+			lastSum += failures[k].lastDetect - failures[k].failedAt;
+			detected++;
+		}
+	}
+	*firstMean = detected ? (double)firstSum / detected : 0.0;
+	*lastMean = detected ? (double)lastSum / detected : 0.0;
+	return detected;
+}
+
+/**
+ * FUNCTION NAME: summary
+ *
+ * DESCRIPTION: The scalar metrics of the run, by name
+ */
+void Metrics::summary(EmulNet *en, int ticks, vector<pair<string, double> > &values) {
+	MsgStats &stats = en->ENstats();
+	long sent = 0, recv = 0, bytes = 0, busiest = 0;
+	long joinSum = 0, joinMax = 0;
+	int joined = 0, pending = 0, detected;
+	double firstMean, lastMean;
+	int numNodes = nodes.size() - 1;
+	unsigned int k;
+
+	for ( int id = 1; id <= numNodes; id++ ) {
+		sent += stats.getSentTotal(id);
+		recv += stats.getRecvTotal(id);
+		bytes += stats.getSentBytes(id);
+		busiest = max(busiest, stats.getSentTotal(id));
+		if ( nodes[id].fullAt >= 0 ) {
+			joinSum += nodes[id].fullAt - nodes[id].startedAt;
+			joinMax = max(joinMax, (long)(nodes[id].fullAt - nodes[id].startedAt));
+			joined++;
+		}
+	}
+	for ( k = 0; k < failures.size(); k++ ) {
+		pending += !failures[k].recovered;
+	}
+	detected = getDetected(&firstMean, &lastMean);
+	double nodeTicks = (double)max(numNodes, 1) * max(ticks, 1);
+
+	values.push_back(make_pair("nodes", (double)numNodes));
+	values.push_back(make_pair("ticks", (double)ticks));
+	values.push_back(make_pair("join.nodes_fully_joined", (double)joined));
+	values.push_back(make_pair("join.mean_ticks", joined ? (double)joinSum / joined : 0.0));
+	values.push_back(make_pair("join.max_ticks", (double)joinMax));
+	values.push_back(make_pair("join.group_joined_at", (double)groupJoinedAt));
+	values.push_back(make_pair("detection.failures", (double)pending));
+	values.push_back(make_pair("detection.detected", (double)detected));
+	values.push_back(make_pair("detection.first_mean_ticks", firstMean));
+	values.push_back(make_pair("detection.last_mean_ticks", lastMean));
+	values.push_back(make_pair("false_removals", (double)falseRemovals));
+	values.push_back(make_pair("reconverge.heals", (double)heals));
+	values.push_back(make_pair("reconverge.reconverged", (double)reconverged));
+	values.push_back(make_pair("reconverge.max_ticks", (double)reconvergeMax));
+	values.push_back(make_pair("traffic.msgs_sent_per_node_per_tick", sent / nodeTicks));
+	values.push_back(make_pair("traffic.msgs_recv_per_node_per_tick", recv / nodeTicks));
+	values.push_back(make_pair("traffic.bytes_sent_per_node_per_tick", bytes / nodeTicks));
+	values.push_back(make_pair("traffic.busiest_node_msgs_per_tick", (double)busiest / max(ticks, 1)));
+	for ( int r = 0; r < DROP_REASONS; r++ ) {
+		values.push_back(make_pair(string("drops.") + dropNames[r], (double)en->ENdropped(r)));
+	}
+	values.push_back(make_pair("run.wall_seconds", wallSeconds));
+	values.push_back(make_pair("run.wall_ms_per_tick", wallSeconds * 1000 / max(ticks, 1)));
+	values.push_back(make_pair("run.peak_rss_kb", (double)peakRssKb));
+	values.push_back(make_pair("run.slab_high_water_bytes", (double)en->ENslab().getHighWater()));
+	values.push_back(make_pair("run.slab_reserved_bytes", (double)en->ENslab().getBytesReserved()));
+}
+
+/**
+ * FUNCTION NAME: dump
+ *
+ * DESCRIPTION: Write the metrics to metrics.json and, one name,value per
+ * 				line, to metrics.csv. Returns false if a file cannot be
+ * 				written.
+ */
+bool Metrics::dump(EmulNet *en, int ticks, const char *protocol) {
+	vector<pair<string, double> > values;
+	unsigned int k;
+
+	summary(en, ticks, values);
+
+	FILE *json = fopen(METRICS_JSON, "w");
+	FILE *csv = fopen(METRICS_CSV, "w");
+	if ( json == NULL || csv == NULL ) {
+		if ( json != NULL ) {
+			fclose(json);
+		}
+		if ( csv != NULL ) {
+			fclose(csv);
+		}
+		return false;
+	}
+
+	fprintf(json, "{\n  \"protocol\": \"%s\",\n", protocol);
+	fprintf(csv, "name,value\nprotocol,%s\n", protocol);
+	for ( k = 0; k < values.size(); k++ ) {
+		fprintf(json, "  \"%s\": %.6g,\n", values[k].first.c_str(), values[k].second);
+		fprintf(csv, "%s,%.6g\n", values[k].first.c_str(), values[k].second);
+	}
+	fprintf(json, "  \"failures\": [");
+	for ( k = 0; k < failures.size(); k++ ) {
+		FailureRecord &f = failures[k];
+		fprintf(json, "%s\n    {\"node\": %d, \"failed_at\": %d, \"first_detect\": %d, \"last_detect\": %d, \"recovered\": %s}",
+				k ? "," : "", f.id, f.failedAt, f.firstDetect, f.lastDetect, f.recovered ? "true" : "false");
+		fprintf(csv, "failure.%u.node,%d\nfailure.%u.failed_at,%d\nfailure.%u.first_detect,%d\nfailure.%u.last_detect,%d\nfailure.%u.recovered,%d\n",
+				k, f.id, k, f.failedAt, k, f.firstDetect, k, f.lastDetect, k, f.recovered);
+	}
+	fprintf(json, "%s]\n}\n", failures.empty() ? "" : "\n  ");
+
+	fclose(json);
+	fclose(csv);
+	return true;
+}
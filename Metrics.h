@@ -0,0 +1,97 @@
+/**********************************
+ * FILE NAME: Metrics.h
+ *
+ * DESCRIPTION: Header file of the metrics registry of a run
+ **********************************/
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include "MsgStats.h"
+
+/*
+ * Macros
+ */
+#define METRICS_JSON "metrics.json"
+#define METRICS_CSV "metrics.csv"
+
+/**
+ * STRUCT NAME: FailureRecord
+ *
+ * DESCRIPTION: One failure of a node that was in the group, and the ticks at
+ * 				which the first and the last live node dropped it (-1 while
+ * 				nobody / not everybody has)
+ */
+typedef struct FailureRecord {
+	int id;
+	int failedAt;
+	int firstDetect;
+	int lastDetect;
+	bool recovered;
+}FailureRecord;
+
+/**
+ * CLASS NAME: Metrics
+ *
+ * DESCRIPTION: What a run is judged by: time to full join, detection
+ * 				latency of each failure, false removals, reconvergence after
+ * 				heals, message load and drops, and what it cost in wall time
+ * 				and memory. Nodes are indexed by id, 1 .. numNodes.
+ *
+ * 				The nodes report joins and removals from whatever thread
+ * 				runs them, touching only their own counters; tick() folds
+ * 				those in from the application thread after the nodes ran,
+ * 				the way the LogSinks are replayed. The message load and the
+ * 				drops are read from EmulNet at the end.
+ */
+class Metrics {
+private:
+	struct NodeMetrics {
+		int startedAt;
+		int fullAt;
+		int members;
+		bool failed;
+		// open failure of this node in failures, or -1
+		int failure;
+		// ids the node dropped from its list since the last tick()
+		vector<int> removed;
+		NodeMetrics(): startedAt(-1), fullAt(-1), members(0), failed(false), failure(-1) {}
+	};
+	vector<NodeMetrics> nodes;
+	vector<FailureRecord> failures;
+	long falseRemovals;
+	int groupJoinedAt;
+	// Heals, how many of them the group reconverged after, and the most
+	// ticks that took
+	int heals;
+	int reconverged;
+	int reconvergeMax;
+	// What the run cost the simulator
+	double wallSeconds;
+	long peakRssKb;
+	void summary(EmulNet *en, int ticks, vector<pair<string, double> > &values);
+public:
+	Metrics();
+	void init(int numNodes);
+	void nodeStarted(int id, int time);
+	void memberAdded(int id);
+	void memberRemoved(int id, int subject);
+	void tick(int time);
+	void nodeFailed(int id, int time, bool inGroup);
+	void nodeRecovered(int id);
+	void failureCleared(int id, int time);
+	void healed() {
+		heals++;
+	}
+	void reconvergedAfter(int ticks);
+	void runCost(double seconds, long rssKb);
+	int getDetected(double *firstMean, double *lastMean);
+	int getFailures() {
+		return failures.size();
+	}
+	bool dump(EmulNet *en, int ticks, const char *protocol);
+};
+
+#endif /* _METRICS_H_ */
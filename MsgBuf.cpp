@@ -0,0 +1,61 @@
+/**********************************
+ * FILE NAME: MsgBuf.cpp
+ *
+ * DESCRIPTION: Definition of the reference counted message buffer
+ **********************************/
+
+#include "MsgBuf.h"
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Allocate a buffer for size payload bytes holding one reference
+ */
+MsgBuf *MsgBuf::create(int size, SlabAllocator *pool) {
+	MsgBuf *buf;
+	if ( pool != NULL ) {
+		buf = (MsgBuf *) pool->alloc(sizeof(MsgBuf) + size);
+	}
+	else {
+		buf = (MsgBuf *) malloc(sizeof(MsgBuf) + size);
+	}
+	buf->refcount = 1;
+	buf->size = size;
+	buf->pool = pool;
+	return buf;
+}
+
+/**
+ * FUNCTION NAME: fromData
+ *
+ * DESCRIPTION: Recover the buffer from a payload pointer returned by data()
+ */
+MsgBuf *MsgBuf::fromData(void *data) {
+	return (MsgBuf *)data - 1;
+}
+
+/**
+ * FUNCTION NAME: retain
+ *
+ * DESCRIPTION: Take one more reference
+ */
+MsgBuf *MsgBuf::retain() {
+	__atomic_add_fetch(&refcount, 1, __ATOMIC_RELAXED);
+	return this;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Drop one reference, freeing the buffer on the last one
+ */
+void MsgBuf::release() {
+	if ( __atomic_sub_fetch(&refcount, 1, __ATOMIC_ACQ_REL) == 0 ) {
+		if ( pool != NULL ) {
+			pool->release(this);
+		}
+		else {
+			free(this);
+		}
+	}
+}
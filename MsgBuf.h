@@ -0,0 +1,41 @@
+/**********************************
+ * FILE NAME: MsgBuf.h
+ *
+ * DESCRIPTION: Header file of the reference counted message buffer
+ **********************************/
+
+#ifndef _MSGBUF_H_
+#define _MSGBUF_H_
+
+#include "stdincludes.h"
+#include "Slab.h"
+
+/**
+ * CLASS NAME: MsgBuf
+ *
+ * DESCRIPTION: Reference counted message payload. The payload bytes follow
+ * 				the header in the same allocation, so a buffer is built once
+ * 				by the sender and then handed through EmulNet and the node
+ * 				queues by pointer. Whoever holds a reference calls release()
+ * 				when done with it; the last release frees the buffer.
+ * 				The count is atomic since the receivers of one buffer may
+ * 				run on different threads.
+ */
+class MsgBuf {
+public:
+	// Number of outstanding references
+	int refcount;
+	// Number of payload bytes after the header
+	int size;
+	// Allocator the buffer came from, NULL for malloc
+	SlabAllocator *pool;
+	static MsgBuf *create(int size, SlabAllocator *pool = NULL);
+	static MsgBuf *fromData(void *data);
+	char *data() {
+		return (char *)(this + 1);
+	}
+	MsgBuf *retain();
+	void release();
+};
+
+#endif /* _MSGBUF_H_ */
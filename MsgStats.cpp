@@ -0,0 +1,96 @@
+/**********************************
+ * FILE NAME: MsgStats.cpp
+ *
+ * DESCRIPTION: Definition of the per node message accounting of EmulNet
+ **********************************/
+
+#include "MsgStats.h"
+
+/**
+ * Constructor
+ */
+MsgStats::MsgStats(): width(1) {}
+
+/**
+ * FUNCTION NAME: init
+ *
+ * DESCRIPTION: Size the table for node ids 0 .. numNodes over a run of
+ * 				ticks ticks
+ */
+void MsgStats::init(int numNodes, int ticks) {
+	long cells = (long)(numNodes + 1) * ticks;
+	width = (int)((cells + MSGSTATS_CELLS - 1) / MSGSTATS_CELLS);
+	if ( width < 1 ) {
+		width = 1;
+	}
+	nodes.clear();
+	nodes.resize(numNodes + 1);
+}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Make room for node id. Not safe against concurrent counting.
+ */
+void MsgStats::addNode(int id) {
+	if ( id >= (int)nodes.size() ) {
+		nodes.resize(id + 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: bump
+ *
+ * DESCRIPTION: Add n to a bucket, growing the counts up to it
+ */
+void MsgStats::bump(vector<int> &counts, int bucket, int n) {
+	if ( bucket >= (int)counts.size() ) {
+		counts.resize(bucket + 1, 0);
+	}
+	counts[bucket] += n;
+}
+
+/**
+ * FUNCTION NAME: countSent
+ *
+ * DESCRIPTION: Count a message of bytes bytes sent by node id at time
+ */
+void MsgStats::countSent(int id, int time, int bytes) {
+	addNode(id);
+	NodeStats &node = nodes[id];
+	bump(node.sent, time / width, 1);
+	node.sentTotal++;
+	node.sentBytes += bytes;
+}
+
+/**
+ * FUNCTION NAME: countRecv
+ *
+ * DESCRIPTION: Count n messages received by node id at time. The node must
+ * 				have been added already.
+ */
+void MsgStats::countRecv(int id, int time, int n) {
+	NodeStats &node = nodes[id];
+	bump(node.recv, time / width, n);
+	node.recvTotal += n;
+}
+
+/**
+ * FUNCTION NAME: getSent
+ *
+ * DESCRIPTION: Messages sent by node id during a bucket
+ */
+int MsgStats::getSent(int id, int bucket) {
+	vector<int> &counts = nodes[id].sent;
+	return bucket < (int)counts.size() ? counts[bucket] : 0;
+}
+
+/**
+ * FUNCTION NAME: getRecv
+ *
+ * DESCRIPTION: Messages received by node id during a bucket
+ */
+int MsgStats::getRecv(int id, int bucket) {
+	vector<int> &counts = nodes[id].recv;
+	return bucket < (int)counts.size() ? counts[bucket] : 0;
+}
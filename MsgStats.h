@@ -0,0 +1,68 @@
+/**********************************
+ * FILE NAME: MsgStats.h
+ *
+ * DESCRIPTION: Header file of the per node message accounting of EmulNet
+ **********************************/
+
+#ifndef _MSGSTATS_H_
+#define _MSGSTATS_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// most (node, bucket) counter cells a run keeps; longer or larger runs
+// widen the buckets instead
+#define MSGSTATS_CELLS (1 << 22)
+
+/**
+ * CLASS NAME: MsgStats
+ *
+ * DESCRIPTION: Messages sent and received per node over time. Ticks are
+ * 				grouped in buckets of a width chosen from the number of
+ * 				nodes and the run length, so the counters stay under
+ * 				MSGSTATS_CELLS cells; small runs get one bucket per tick.
+ * 				A node's buckets are only allocated up to the last one it
+ * 				used, and separate nodes may be counted from separate
+ * 				threads.
+ */
+class MsgStats {
+private:
+	struct NodeStats {
+		vector<int> sent;
+		vector<int> recv;
+		long sentTotal;
+		long recvTotal;
+		long sentBytes;
+		NodeStats(): sentTotal(0), recvTotal(0), sentBytes(0) {}
+	};
+	int width;
+	vector<NodeStats> nodes;
+	static void bump(vector<int> &counts, int bucket, int n);
+public:
+	MsgStats();
+	void init(int numNodes, int ticks);
+	void addNode(int id);
+	void countSent(int id, int time, int bytes);
+	void countRecv(int id, int time, int n);
+	int getWidth() {
+		return width;
+	}
+	int getNumNodes() {
+		return nodes.size();
+	}
+	int getSent(int id, int bucket);
+	int getRecv(int id, int bucket);
+	long getSentTotal(int id) {
+		return nodes[id].sentTotal;
+	}
+	long getRecvTotal(int id) {
+		return nodes[id].recvTotal;
+	}
+	long getSentBytes(int id) {
+		return nodes[id].sentBytes;
+	}
+};
+
+#endif /* _MSGSTATS_H_ */
@@ -5,6 +5,7 @@
  **********************************/
 
 #include "Params.h"
+#include <limits.h>
 
 /**
  * Constructor
@@ -14,31 +15,389 @@ Params::Params(): PORTNUM(8001) {}
 /**
  * FUNCTION NAME: setparams
  *
- * DESCRIPTION: Set the parameters for this test case
+ * DESCRIPTION: Set the parameters for this test case.
+ *
+ * 				The file has one "KEY: value" per line, in any order; text
+ * 				after a '#' is ignored. Besides the settings below it may
+ * 				hold any number of EVENT lines (see addEvent). Without
+ * 				EVENT lines the schedule of the original test cases is
+ * 				built from SINGLE_FAILURE, DROP_MSG and MSG_DROP_PROB.
  */
 void Params::setparams(char *config_file) {
 	FILE *fp = fopen(config_file,"r");
+	if ( fp == NULL ) {
+		fprintf(stderr, "Cannot open configuration file %s\n", config_file);
+		exit(1);
+	}
 
-	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
-	fscanf(fp,"\nSINGLE_FAILURE: %d", &SINGLE_FAILURE);
-	fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
-	fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
+	MAX_NNB = 10;
+	SINGLE_FAILURE = 1;
+	DROP_MSG = 0;
+	MSG_DROP_PROB = 0;
+	STEP_RATE = .25;
+	MAX_MSG_SIZE = 4000;
+	ARENA_RESET = 0;
+	PROTOCOL = PROTOCOL_GOSSIP;
+	SWIM_K = 3;
+	GOSSIP_ADAPTIVE = 0;
+	GOSSIP_MODE = GOSSIP_FULL;
+	DELTA_STEP = 1;
+	FULL_SYNC = 10;
+	THREADS = 1;
+	SEED = (int)time(NULL);
+	LOG_BINARY = 0;
+	RUN_LENGTH = TOTAL_RUNNING_TIME;
+	LATENCY = 1;
+	LINK_SPREAD = 0;
+	JITTER = 0;
+	JITTER_DIST = JITTER_UNIFORM;
+	REORDER = 0;
+	BANDWIDTH = 0;
+	QUEUE_LIMIT = 0;
+	BUFF_SIZE = 0;
+	events.clear();
+
+	char line[256];
+	char key[64];
+	char value[192];
+	int lineno = 0;
+	while ( fgets(line, sizeof(line), fp) != NULL ) {
+		lineno++;
+		char *comment = strchr(line, '#');
+		if ( comment != NULL ) {
+			*comment = 0;
+		}
+		if ( sscanf(line, " %63[^: \t\n] : %191[^\n]", key, value) != 2 ) {
+			if ( strspn(line, " \t\r\n") != strlen(line) ) {
+				fprintf(stderr, "%s:%d: expected KEY: value\n", config_file, lineno);
+			}
+			continue;
+		}
+		if ( !setparam(key, value) ) {
+			fprintf(stderr, "%s:%d: bad setting %s: %s\n", config_file, lineno, key, value);
+		}
+	}
+	fclose(fp);
 
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
-	STEP_RATE=.25;
-	MAX_MSG_SIZE = 4000;
+	// The dissemination buffer carries state changes but no heartbeats, so
+	// buffer mode tells who is alive with the probes of SWIM
+	if ( GOSSIP_MODE == GOSSIP_BUFFER ) {
+		PROTOCOL = PROTOCOL_SWIM;
+	}
 	globaltime = 0;
 	dropmsg = 0;
 	allNodesJoined = 0;
 	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
-	fclose(fp);
+
+	if ( events.empty() ) {
+		// Drop messages between t=50 and t=300, fail one node or half of
+		// them at t=100
+		if ( DROP_MSG ) {
+			char drop[64];
+			sprintf(drop, "50 drop %f", MSG_DROP_PROB);
+			addEvent(drop);
+			addEvent("300 drop 0");
+		}
+		char fail[64];
+		sprintf(fail, "100 fail random %d", SINGLE_FAILURE ? 1 : EN_GPSZ/2);
+		addEvent(fail);
+	}
+
+	// Drop the events naming nodes that do not exist
+	unsigned int kept = 0;
+	for ( unsigned int i = 0; i < events.size(); i++ ) {
+		SimEvent &e = events[i];
+		bool ok = e.last < EN_GPSZ && e.toLast < EN_GPSZ && e.count <= EN_GPSZ;
+		if ( !ok ) {
+			fprintf(stderr, "%s: event at t=%d names nodes beyond MAX_NNB %d\n", config_file, e.time, EN_GPSZ);
+			continue;
+		}
+		events[kept++] = e;
+	}
+	events.resize(kept);
+	stable_sort(events.begin(), events.end(), [](const SimEvent &a, const SimEvent &b) {
+		return a.time < b.time;
+	});
 	return;
 }
 
+/**
+ * FUNCTION NAME: setparam
+ *
+ * DESCRIPTION: Set one KEY: value pair. Returns false for an unknown key or
+ * 				a value that does not parse or is out of the range of the key
+ * 				(a count that must be positive, a flag, an enum).
+ */
+bool Params::setparam(const char *key, const char *value) {
+	int *intKey = NULL;
+	double *doubleKey = NULL;
+	// Range of the value of intKey
+	long low = 0, high = INT_MAX;
+	char *end;
+
+	if ( 0 == strcmp(key, "EVENT") ) {
+		return addEvent(value);
+	}
+	if ( 0 == strcmp(key, "MSG_DROP_PROB") ) {
+		doubleKey = &MSG_DROP_PROB;
+	}
+	else if ( 0 == strcmp(key, "STEP_RATE") ) {
+		doubleKey = &STEP_RATE;
+	}
+	else if ( 0 == strcmp(key, "LATENCY") ) {
+		doubleKey = &LATENCY;
+	}
+	else if ( 0 == strcmp(key, "LINK_SPREAD") ) {
+		doubleKey = &LINK_SPREAD;
+	}
+	else if ( 0 == strcmp(key, "JITTER") ) {
+		doubleKey = &JITTER;
+	}
+	else if ( 0 == strcmp(key, "REORDER") ) {
+		doubleKey = &REORDER;
+	}
+	if ( doubleKey != NULL ) {
+		double v = strtod(value, &end);
+		if ( end == value || v < 0 ) {
+			return false;
+		}
+		*doubleKey = v;
+		return true;
+	}
+
+	if ( 0 == strcmp(key, "MAX_NNB") ) {
+		intKey = &MAX_NNB;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "SINGLE_FAILURE") ) {
+		intKey = &SINGLE_FAILURE;
+		low = 0;
+		high = 1;
+	}
+	else if ( 0 == strcmp(key, "DROP_MSG") ) {
+		intKey = &DROP_MSG;
+		low = 0;
+		high = 1;
+	}
+	else if ( 0 == strcmp(key, "MAX_MSG_SIZE") ) {
+		intKey = &MAX_MSG_SIZE;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "ARENA_RESET") ) {
+		intKey = &ARENA_RESET;
+		low = 0;
+		high = 1;
+	}
+	else if ( 0 == strcmp(key, "PROTOCOL") ) {
+		intKey = &PROTOCOL;
+		low = 0;
+		high = PROTOCOL_SWIM;
+	}
+	else if ( 0 == strcmp(key, "SWIM_K") ) {
+		intKey = &SWIM_K;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_ADAPTIVE") ) {
+		intKey = &GOSSIP_ADAPTIVE;
+		low = 0;
+		high = 1;
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_MODE") ) {
+		intKey = &GOSSIP_MODE;
+		low = 0;
+		high = GOSSIP_BUFFER;
+	}
+	else if ( 0 == strcmp(key, "DELTA_STEP") ) {
+		intKey = &DELTA_STEP;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "FULL_SYNC") ) {
+		intKey = &FULL_SYNC;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "THREADS") ) {
+		intKey = &THREADS;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "SEED") ) {
+		intKey = &SEED;
+		low = INT_MIN;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "LOG_BINARY") ) {
+		intKey = &LOG_BINARY;
+		low = 0;
+		high = 1;
+	}
+	else if ( 0 == strcmp(key, "RUN_LENGTH") ) {
+		intKey = &RUN_LENGTH;
+		low = 1;
+		high = INT_MAX;
+	}
+	else if ( 0 == strcmp(key, "JITTER_DIST") ) {
+		intKey = &JITTER_DIST;
+		low = 0;
+		high = JITTER_EXPONENTIAL;
+	}
+	else if ( 0 == strcmp(key, "BANDWIDTH") ) {
+		intKey = &BANDWIDTH;
+	}
+	else if ( 0 == strcmp(key, "QUEUE_LIMIT") ) {
+		intKey = &QUEUE_LIMIT;
+	}
+	else if ( 0 == strcmp(key, "BUFF_SIZE") ) {
+		intKey = &BUFF_SIZE;
+	}
+	else {
+		return false;
+	}
+
+	long v = strtol(value, &end, 10);
+	if ( end == value || v < low || v > high ) {
+		return false;
+	}
+	*intKey = (int)v;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: parseRange
+ *
+ * DESCRIPTION: Parse a node index or an inclusive range a-b
+ */
+static bool parseRange(const char *str, int *first, int *last) {
+	int n = 0;
+	int fields = sscanf(str, "%d%n-%d%n", first, &n, last, &n);
+	if ( fields == 1 ) {
+		*last = *first;
+	}
+	return fields >= 1 && str[n] == 0 && *first >= 0 && *last >= *first;
+}
+
+/**
+ * FUNCTION NAME: addEvent
+ *
+ * DESCRIPTION: Parse the value of an EVENT line and add it to the schedule.
+ * 				Nodes are indices from 0 to MAX_NNB - 1; a range a-b is
+ * 				inclusive.
+ *
+ * 				<time> fail <node>[-<node>]       stop the nodes
+ * 				<time> fail random <count>        stop count adjacent nodes
+ * 				                                  at a random place
+ * 				<time> recover <node>[-<node>]    restart failed nodes
+ * 				<time> partition <node>[-<node>]  cut the nodes off from
+ * 				                                  all the others
+ * 				<time> cut <nodes> <nodes> [prob] drop the messages from the
+ * 				                                  first nodes to the second
+ * 				                                  ones (one way), with
+ * 				                                  probability prob (1)
+ * 				<time> heal                       undo all partitions and
+ * 				                                  cuts
+ * 				<time> drop <prob>                drop messages with
+ * 				                                  probability prob from
+ * 				                                  now on, 0 to stop
+ *
+ * 				partition and cut may end with "for <ticks>" to schedule
+ * 				a heal of that partition or cut alone that much later.
+ */
+bool Params::addEvent(const char *value) {
+	SimEvent e;
+	char word[6][64];
+	int words;
+
+	e.first = e.last = e.toFirst = e.toLast = e.count = 0;
+	e.prob = 0;
+	e.fault = 0;
+	words = sscanf(value, "%d %63s %63s %63s %63s %63s %63s", &e.time, word[0], word[1], word[2], word[3], word[4], word[5]) - 1;
+	if ( words < 1 || e.time < 0 ) {
+		return false;
+	}
+
+	// Trailing "for <ticks>"
+	int duration = -1;
+	if ( words >= 3 && 0 == strcmp(word[words-2], "for") ) {
+		if ( sscanf(word[words-1], "%d", &duration) != 1 || duration < 1 ) {
+			return false;
+		}
+		words -= 2;
+	}
+
+	if ( 0 == strcmp(word[0], "heal") && words == 1 ) {
+		e.type = EVENT_HEAL;
+	}
+	else if ( 0 == strcmp(word[0], "drop") && words == 2 ) {
+		e.type = EVENT_DROP;
+		if ( sscanf(word[1], "%lf", &e.prob) != 1 || e.prob < 0 || e.prob > 1 ) {
+			return false;
+		}
+	}
+	else if ( 0 == strcmp(word[0], "fail") && words == 3 && 0 == strcmp(word[1], "random") ) {
+		e.type = EVENT_FAIL;
+		if ( sscanf(word[2], "%d", &e.count) != 1 || e.count < 1 ) {
+			return false;
+		}
+		e.first = e.last = -1;
+	}
+	else if ( 0 == strcmp(word[0], "cut") && (words == 3 || words == 4) ) {
+		e.type = EVENT_CUT;
+		e.prob = 1;
+		if ( !parseRange(word[1], &e.first, &e.last) || !parseRange(word[2], &e.toFirst, &e.toLast) ) {
+			return false;
+		}
+		if ( words == 4 && (sscanf(word[3], "%lf", &e.prob) != 1 || e.prob <= 0 || e.prob > 1) ) {
+			return false;
+		}
+	}
+	else if ( words == 2 ) {
+		if ( 0 == strcmp(word[0], "fail") ) {
+			e.type = EVENT_FAIL;
+		}
+		else if ( 0 == strcmp(word[0], "recover") ) {
+			e.type = EVENT_RECOVER;
+		}
+		else if ( 0 == strcmp(word[0], "partition") ) {
+			e.type = EVENT_PARTITION;
+		}
+		else {
+			return false;
+		}
+		if ( !parseRange(word[1], &e.first, &e.last) ) {
+			return false;
+		}
+	}
+	else {
+		return false;
+	}
+
+	if ( duration > 0 && e.type != EVENT_PARTITION && e.type != EVENT_CUT ) {
+		return false;
+	}
+
+	// Faults are numbered in the order they are added, from 1
+	if ( e.type == EVENT_PARTITION || e.type == EVENT_CUT ) {
+		e.fault = events.size() + 1;
+	}
+	events.push_back(e);
+	if ( duration > 0 ) {
+		SimEvent heal = e;
+		heal.time = e.time + duration;
+		heal.type = EVENT_HEAL;
+		events.push_back(heal);
+	}
+	return true;
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
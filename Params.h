@@ -13,6 +13,42 @@
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
 
+// default number of ticks in a run
+#define TOTAL_RUNNING_TIME 700
+// virtual time units per tick, the resolution of message latency
+#define SUBTICKS 1000
+
+enum gossipMODE { GOSSIP_FULL, GOSSIP_DELTA, GOSSIP_SUBSET, GOSSIP_BUFFER };
+
+enum jitterDIST { JITTER_UNIFORM, JITTER_EXPONENTIAL };
+
+enum protocolMODE { PROTOCOL_GOSSIP, PROTOCOL_SWIM };
+
+enum eventTYPE { EVENT_FAIL, EVENT_RECOVER, EVENT_PARTITION, EVENT_CUT, EVENT_HEAL, EVENT_DROP };
+
+/**
+ * Struct Name: SimEvent
+ *
+ * DESCRIPTION: One entry of the failure schedule, applied at the end of
+ * 				tick time to the nodes first .. last (indices, inclusive)
+ */
+typedef struct SimEvent {
+	int time;
+	int type;
+	int first;
+	int last;
+	// receiving side of EVENT_CUT
+	int toFirst;
+	int toLast;
+	// nodes to pick at random when first is -1
+	int count;
+	// drop probability of EVENT_DROP and EVENT_CUT
+	double prob;
+	// fault opened by EVENT_PARTITION or EVENT_CUT, which the heal that
+	// ends its "for <ticks>" undoes; 0 for a heal of all of them
+	int fault;
+}SimEvent;
+
 /**
  * CLASS NAME: Params
  *
@@ -31,8 +67,30 @@ public:
 	int globaltime;
 	int allNodesJoined;
 	short PORTNUM;
+	int ARENA_RESET;            // reset the network arena every tick
+	int PROTOCOL;               // heartbeat gossip or SWIM probing
+	int SWIM_K;                 // members asked to probe indirectly in SWIM mode
+	int GOSSIP_ADAPTIVE;        // fanout and gossip interval follow the group
+	int GOSSIP_MODE;            // full list, deltas, a random subset or the least sent changes (with SWIM) per gossip
+	int DELTA_STEP;             // heartbeat advance that counts as a change
+	int FULL_SYNC;              // ticks between full lists in delta mode
+	int THREADS;                // threads running the nodes of a tick
+	int SEED;                   // seed of all the random streams of the run
+	int LOG_BINARY;             // log records to dbg.bin instead of text to dbg.log
+	int RUN_LENGTH;             // number of ticks in the run
+	double LATENCY;             // message latency, in ticks
+	double LINK_SPREAD;         // extra fixed latency of a link, up to this
+	double JITTER;              // extra latency drawn per message, in ticks
+	int JITTER_DIST;            // JITTER is a uniform range or an exponential mean
+	double REORDER;             // probability of holding a message one more tick
+	int BANDWIDTH;              // bytes a node sends per tick, 0 for no limit
+	int QUEUE_LIMIT;            // ticks of send backlog before dropping, 0 for no limit
+	int BUFF_SIZE;              // messages in flight before dropping, 0 (default) for 100 per node and tick in flight
+	vector<SimEvent> events;    // failure schedule, in time order
 	Params();
 	void setparams(char *);
+	bool setparam(const char *, const char *);
+	bool addEvent(const char *);
 	int getcurrtime();
 };
 
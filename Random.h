@@ -0,0 +1,82 @@
+/**********************************
+ * FILE NAME: Random.h
+ *
+ * DESCRIPTION: Seeded random number streams of the simulation
+ **********************************/
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Macros
+ */
+// stream ids; every node gets its own stream after the fixed ones
+#define RNG_STREAM_NET 0
+#define RNG_STREAM_FAIL 1
+#define RNG_STREAM_NODE(id) (2 + (uint64_t)(id))
+
+/**
+ * CLASS NAME: Random
+ *
+ * DESCRIPTION: xoshiro256** generator. The state is expanded with splitmix64
+ * 				from the run seed and a stream id, so every user of
+ * 				randomness draws from its own sequence: a run is fixed by its
+ * 				seed, whatever the order in which the streams are used.
+ */
+class Random {
+private:
+	uint64_t s[4];
+	static uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+	static uint64_t splitmix64(uint64_t &x) {
+		return mix(x += 0x9E3779B97F4A7C15ULL);
+	}
+public:
+	// splitmix64 finalizer: a stateless hash of x
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+	// uniform in [0, 1) from the top 53 bits of h
+	static double toUnit(uint64_t h) {
+		return (h >> 11) * (1.0 / 9007199254740992.0);
+	}
+	Random() {
+		seed(0, 0);
+	}
+	Random(uint64_t seed, uint64_t stream) {
+		this->seed(seed, stream);
+	}
+	void seed(uint64_t seed, uint64_t stream) {
+		uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+		for ( int i = 0; i < 4; i++ ) {
+			s[i] = splitmix64(x);
+		}
+	}
+	uint64_t next() {
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+	// uniform in [0, n), n > 0
+	int below(int n) {
+		return (int)(((next() >> 32) * (uint64_t)n) >> 32);
+	}
+	// uniform in [0, 1)
+	double uniform() {
+		return toUnit(next());
+	}
+};
+
+#endif /* _RANDOM_H_ */
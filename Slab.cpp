@@ -0,0 +1,280 @@
+/**********************************
+ * FILE NAME: Slab.cpp
+ *
+ * DESCRIPTION: Definition of the size class slab allocator
+ **********************************/
+
+#include "Slab.h"
+
+atomic<long> SlabAllocator::serials(0);
+thread_local SlabCache *SlabAllocator::cache = NULL;
+
+/**
+ * Constructor
+ */
+SlabAllocator::SlabAllocator(): mode(SLAB_FREELIST), gen(0), bytesInUse(0), highWater(0), bytesReserved(0), ticks(0) {
+	serial = ++serials;
+	for ( int i = 0; i < SLAB_NUM_CLASSES; i++ ) {
+		freelist[i] = NULL;
+	}
+	for ( int g = 0; g < 2; g++ ) {
+		gens[g].cur = 0;
+		gens[g].used = 0;
+		gens[g].bytes = 0;
+	}
+}
+
+/**
+ * Destructor
+ */
+SlabAllocator::~SlabAllocator() {
+	for ( int g = 0; g < 2; g++ ) {
+		for ( unsigned int i = 0; i < gens[g].chunks.size(); i++ ) {
+			free(gens[g].chunks[i]);
+		}
+	}
+	for ( unsigned int i = 0; i < caches.size(); i++ ) {
+		delete caches[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: setMode
+ *
+ * DESCRIPTION: Select SLAB_FREELIST or SLAB_TICK. Must be called before the
+ * 				first allocation.
+ */
+void SlabAllocator::setMode(int mode) {
+	this->mode = mode;
+}
+
+/**
+ * FUNCTION NAME: sizeClass
+ *
+ * DESCRIPTION: Return the class of a block of size bytes, -1 if too large
+ */
+int SlabAllocator::sizeClass(size_t size) {
+	size_t classBytes = SLAB_MIN_CLASS;
+	for ( int cls = 0; cls < SLAB_NUM_CLASSES; cls++ ) {
+		if ( size <= classBytes ) {
+			return cls;
+		}
+		classBytes <<= 1;
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: carve
+ *
+ * DESCRIPTION: Bump allocate size bytes from the current generation
+ */
+char *SlabAllocator::carve(size_t size) {
+	Generation &g = gens[gen];
+	if ( g.cur >= g.chunks.size() || g.used + size > SLAB_CHUNK_SIZE ) {
+		if ( g.cur < g.chunks.size() ) {
+			g.cur++;
+		}
+		if ( g.cur >= g.chunks.size() ) {
+			g.chunks.push_back((char *) malloc(SLAB_CHUNK_SIZE));
+			bytesReserved += SLAB_CHUNK_SIZE;
+		}
+		g.used = 0;
+	}
+	char *block = g.chunks[g.cur] + g.used;
+	g.used += size;
+	return block;
+}
+
+/**
+ * FUNCTION NAME: localCache
+ *
+ * DESCRIPTION: The cache of the calling thread, created on its first use
+ */
+SlabCache *SlabAllocator::localCache() {
+	if ( cache != NULL && cache->owner == serial ) {
+		return cache;
+	}
+	lock_guard<mutex> guard(lock);
+	thread::id self = this_thread::get_id();
+	for ( unsigned int i = 0; i < caches.size(); i++ ) {
+		if ( caches[i]->tid == self ) {
+			cache = caches[i];
+			return cache;
+		}
+	}
+	cache = new SlabCache();
+	cache->owner = serial;
+	cache->tid = self;
+	for ( int cls = 0; cls < SLAB_NUM_CLASSES; cls++ ) {
+		cache->freelist[cls] = NULL;
+		cache->count[cls] = 0;
+	}
+	cache->region = NULL;
+	cache->regionLeft = 0;
+	cache->regionTick = -1;
+	cache->bytesAllocated = 0;
+	caches.push_back(cache);
+	return cache;
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Move SLAB_BATCH blocks of class cls from the shared pool to
+ * 				the cache c, carving new ones once the pool has none
+ */
+void SlabAllocator::refill(SlabCache *c, int cls) {
+	size_t classBytes = (size_t)SLAB_MIN_CLASS << cls;
+	lock_guard<mutex> guard(lock);
+	for ( int k = 0; k < SLAB_BATCH; k++ ) {
+		char *block = freelist[cls];
+		if ( block != NULL ) {
+			freelist[cls] = *(char **)block;
+		}
+		else {
+			block = carve(classBytes);
+		}
+		*(char **)block = c->freelist[cls];
+		c->freelist[cls] = block;
+	}
+	c->count[cls] += SLAB_BATCH;
+	bytesInUse += SLAB_BATCH * classBytes;
+	if ( bytesInUse > highWater ) {
+		highWater = bytesInUse;
+	}
+}
+
+/**
+ * FUNCTION NAME: giveBack
+ *
+ * DESCRIPTION: Move n blocks of class cls from the cache c to the shared pool
+ */
+void SlabAllocator::giveBack(SlabCache *c, int cls, int n) {
+	lock_guard<mutex> guard(lock);
+	for ( int k = 0; k < n; k++ ) {
+		char *block = c->freelist[cls];
+		c->freelist[cls] = *(char **)block;
+		*(char **)block = freelist[cls];
+		freelist[cls] = block;
+	}
+	c->count[cls] -= n;
+	bytesInUse -= (long)n * (SLAB_MIN_CLASS << cls);
+}
+
+/**
+ * FUNCTION NAME: takeRegion
+ *
+ * DESCRIPTION: Give the cache c a fresh SLAB_REGION of the current
+ * 				generation to bump allocate from during this tick
+ */
+void SlabAllocator::takeRegion(SlabCache *c) {
+	lock_guard<mutex> guard(lock);
+	c->region = carve(SLAB_REGION);
+	c->regionLeft = SLAB_REGION;
+	c->regionTick = ticks;
+	gens[gen].bytes += SLAB_REGION;
+	bytesInUse += SLAB_REGION;
+	if ( bytesInUse > highWater ) {
+		highWater = bytesInUse;
+	}
+}
+
+/**
+ * FUNCTION NAME: alloc
+ *
+ * DESCRIPTION: Allocate size bytes
+ */
+void *SlabAllocator::alloc(int size) {
+	int cls = sizeClass(size + SLAB_HDR);
+	SlabCache *c = localCache();
+	char *block;
+
+	c->bytesAllocated += size;
+
+	if ( cls < 0 ) {
+		block = (char *) malloc(size + SLAB_HDR);
+		*(int *)block = -1;
+		return block + SLAB_HDR;
+	}
+
+	size_t classBytes = (size_t)SLAB_MIN_CLASS << cls;
+	if ( mode == SLAB_FREELIST ) {
+		if ( c->freelist[cls] == NULL ) {
+			refill(c, cls);
+		}
+		block = c->freelist[cls];
+		c->freelist[cls] = *(char **)block;
+		c->count[cls]--;
+	}
+	else {
+		if ( c->regionTick != ticks || c->regionLeft < classBytes ) {
+			takeRegion(c);
+		}
+		block = c->region;
+		c->region += classBytes;
+		c->regionLeft -= classBytes;
+	}
+	*(int *)block = cls;
+	return block + SLAB_HDR;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Give back a block returned by alloc
+ */
+void SlabAllocator::release(void *ptr) {
+	char *block = (char *)ptr - SLAB_HDR;
+	int cls = *(int *)block;
+
+	if ( cls < 0 ) {
+		free(block);
+		return;
+	}
+	if ( mode == SLAB_TICK ) {
+		// Reclaimed all at once when the generation is rewound
+		return;
+	}
+	SlabCache *c = localCache();
+	*(char **)block = c->freelist[cls];
+	c->freelist[cls] = block;
+	if ( ++c->count[cls] >= 2 * SLAB_BATCH ) {
+		giveBack(c, cls, SLAB_BATCH);
+	}
+}
+
+/**
+ * FUNCTION NAME: tick
+ *
+ * DESCRIPTION: Called at the start of every tick. In SLAB_TICK mode switch to
+ * 				the other generation and rewind it, dropping everything that
+ * 				was allocated from it two ticks ago. The regions the caches
+ * 				took during the last tick are not used any more.
+ */
+void SlabAllocator::tick() {
+	if ( mode != SLAB_TICK ) {
+		return;
+	}
+	lock_guard<mutex> guard(lock);
+	ticks++;
+	gen = 1 - gen;
+	bytesInUse -= gens[gen].bytes;
+	gens[gen].bytes = 0;
+	gens[gen].cur = 0;
+	gens[gen].used = 0;
+}
+
+/**
+ * FUNCTION NAME: getBytesAllocated
+ *
+ * DESCRIPTION: Total bytes requested over the run, by all the threads
+ */
+long SlabAllocator::getBytesAllocated() {
+	lock_guard<mutex> guard(lock);
+	long bytes = 0;
+	for ( unsigned int i = 0; i < caches.size(); i++ ) {
+		bytes += caches[i]->bytesAllocated;
+	}
+	return bytes;
+}
@@ -0,0 +1,130 @@
+/**********************************
+ * FILE NAME: Slab.h
+ *
+ * DESCRIPTION: Header file of the size class slab allocator used by EmulNet
+ **********************************/
+
+#ifndef _SLAB_H_
+#define _SLAB_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// smallest size class, in bytes; each class doubles the previous one
+#define SLAB_MIN_CLASS 32
+#define SLAB_NUM_CLASSES 10
+// size of the chunks the blocks are carved from
+#define SLAB_CHUNK_SIZE (256 * 1024)
+// per block header, keeps the size class of the block
+#define SLAB_HDR 8
+// blocks of a class a thread takes from or gives back to the shared pool at
+// a time; it keeps at most twice as many
+#define SLAB_BATCH 32
+// bytes a thread takes at a time for its own bump allocation (SLAB_TICK)
+#define SLAB_REGION (64 * 1024)
+
+enum SlabMode { SLAB_FREELIST, SLAB_TICK };
+
+/**
+ * STRUCT NAME: SlabCache
+ *
+ * DESCRIPTION: Blocks one thread allocates from without taking the lock of
+ * 				the allocator: free lists per size class (SLAB_FREELIST) or
+ * 				a region to bump allocate from (SLAB_TICK)
+ */
+typedef struct SlabCache {
+	// serial of the allocator and thread the cache belongs to
+	long owner;
+	thread::id tid;
+	char *freelist[SLAB_NUM_CLASSES];
+	int count[SLAB_NUM_CLASSES];
+	// region left to carve, valid for the tick it was taken in
+	char *region;
+	size_t regionLeft;
+	long regionTick;
+	// bytes requested by this thread
+	long bytesAllocated;
+}SlabCache;
+
+/**
+ * CLASS NAME: SlabAllocator
+ *
+ * DESCRIPTION: Size class allocator for the small, short lived buffers of
+ * 				the emulated network (message envelopes and payloads).
+ *
+ * 				SLAB_FREELIST recycles freed blocks through one free list
+ * 				per size class.
+ *
+ * 				SLAB_TICK bump allocates from two generations of chunks and
+ * 				ignores frees; tick() rewinds the generation that was filled
+ * 				two ticks ago. Every block must therefore be dead within one
+ * 				tick boundary of its allocation.
+ *
+ * 				Requests larger than the biggest class go to malloc in both
+ * 				modes.
+ *
+ * 				Each thread allocates from and releases to a SlabCache of
+ * 				its own, which takes or gives back blocks SLAB_BATCH at a
+ * 				time (a SLAB_REGION at a time in SLAB_TICK mode) under the
+ * 				lock of the allocator, so the nodes of a tick may run on
+ * 				several threads without contending for it on every message.
+ * 				tick() must not run concurrently with alloc or release.
+ */
+class SlabAllocator {
+private:
+	struct Generation {
+		vector<char *> chunks;
+		// chunk being carved and the offset of its first unused byte
+		unsigned int cur;
+		size_t used;
+		// bytes handed out from this generation since its last rewind
+		long bytes;
+	};
+	int mode;
+	int gen;
+	Generation gens[2];
+	char *freelist[SLAB_NUM_CLASSES];
+	// bytes out of the shared pool (held by the threads' caches or in use)
+	long bytesInUse;
+	long highWater;
+	long bytesReserved;
+	// ticks since the start, to expire the regions of the caches
+	long ticks;
+	// Guards the shared pool and caches
+	mutex lock;
+	vector<SlabCache *> caches;
+	long serial;
+	static atomic<long> serials;
+	static thread_local SlabCache *cache;
+	static int sizeClass(size_t size);
+	char *carve(size_t size);
+	SlabCache *localCache();
+	void refill(SlabCache *c, int cls);
+	void giveBack(SlabCache *c, int cls, int n);
+	void takeRegion(SlabCache *c);
+public:
+	SlabAllocator();
+	virtual ~SlabAllocator();
+	void setMode(int mode);
+	int getMode() {
+		return mode;
+	}
+	void *alloc(int size);
+	void release(void *ptr);
+	void tick();
+	// total bytes requested over the run
+	long getBytesAllocated();
+	// most bytes (rounded up to their size class) out of the shared pool at
+	// any time, counting those cached by the threads
+	long getHighWater() {
+		return highWater;
+	}
+	// bytes of chunk memory obtained from malloc
+	long getBytesReserved() {
+		return bytesReserved;
+	}
+};
+
+#endif /* _SLAB_H_ */
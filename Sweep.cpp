@@ -0,0 +1,172 @@
+/**********************************
+ * FILE NAME: Sweep.cpp
+ *
+ * DESCRIPTION: Definition of the membership expiry sweep kernels
+ **********************************/
+
+#include "Sweep.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SWEEP_X86 1
+#endif
+
+SweepFn ExpirySweep::impl = NULL;
+const char *ExpirySweep::implName = "none";
+once_flag ExpirySweep::selected;
+
+/**
+ * FUNCTION NAME: hasSSE2
+ *
+ * DESCRIPTION: True if the SSE2 kernel can run here
+ */
+bool ExpirySweep::hasSSE2() {
+#ifdef SWEEP_X86
+	return __builtin_cpu_supports("sse2");
+#else
+	return false;
+#endif
+}
+
+/**
+ * FUNCTION NAME: hasAVX2
+ *
+ * DESCRIPTION: True if the AVX2 kernel can run here
+ */
+bool ExpirySweep::hasAVX2() {
+#ifdef SWEEP_X86
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+/**
+ * FUNCTION NAME: select
+ *
+ * DESCRIPTION: Pick the kernel for this CPU
+ */
+void ExpirySweep::select() {
+	if ( hasAVX2() ) {
+		impl = avx2;
+		implName = "avx2";
+	}
+	else if ( hasSSE2() ) {
+		impl = sse2;
+		implName = "sse2";
+	}
+	else {
+		impl = scalar;
+		implName = "scalar";
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Sweep with the best kernel available
+ */
+void ExpirySweep::run(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	call_once(selected, select);
+	impl(timestamps, n, now, tfail, tremove, suspected, expired);
+}
+
+/**
+ * FUNCTION NAME: name
+ *
+ * DESCRIPTION: Name of the kernel run() uses
+ */
+const char *ExpirySweep::name() {
+	call_once(selected, select);
+	return implName;
+}
+
+/**
+ * FUNCTION NAME: scalar
+ *
+ * DESCRIPTION: Portable kernel, one member at a time
+ */
+void ExpirySweep::scalar(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	for ( int w = 0; w < SWEEP_WORDS(n); w++ ) {
+		uint64_t s = 0, e = 0;
+		int base = w * 64;
+		int end = min(n - base, 64);
+		for ( int j = 0; j < end; j++ ) {
+			long age = now - timestamps[base + j];
+			s |= (uint64_t)(age > tfail) << j;
+			e |= (uint64_t)(age > tremove) << j;
+		}
+		suspected[w] = s;
+		expired[w] = e;
+	}
+}
+
+#ifdef SWEEP_X86
+
+/*
+ * With 64 bit lanes SSE2 has a subtract but no compare, so age > limit is
+ * taken from the sign bit of limit - age.
+ */
+__attribute__((target("sse2")))
+void ExpirySweep::sse2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	__m128i vnow = _mm_set1_epi64x(now);
+	__m128i vfail = _mm_set1_epi64x(tfail);
+	__m128i vremove = _mm_set1_epi64x(tremove);
+	for ( int w = 0; w < SWEEP_WORDS(n); w++ ) {
+		uint64_t s = 0, e = 0;
+		int base = w * 64;
+		int end = min(n - base, 64);
+		int j = 0;
+		for ( ; j + 2 <= end; j += 2 ) {
+			__m128i ts = _mm_loadu_si128((const __m128i *)(timestamps + base + j));
+			__m128i age = _mm_sub_epi64(vnow, ts);
+			s |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(vfail, age))) << j;
+			e |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(vremove, age))) << j;
+		}
+		for ( ; j < end; j++ ) {
+			long age = now - timestamps[base + j];
+			s |= (uint64_t)(age > tfail) << j;
+			e |= (uint64_t)(age > tremove) << j;
+		}
+		suspected[w] = s;
+		expired[w] = e;
+	}
+}
+
+__attribute__((target("avx2")))
+void ExpirySweep::avx2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	__m256i vnow = _mm256_set1_epi64x(now);
+	__m256i vfail = _mm256_set1_epi64x(tfail);
+	__m256i vremove = _mm256_set1_epi64x(tremove);
+	for ( int w = 0; w < SWEEP_WORDS(n); w++ ) {
+		uint64_t s = 0, e = 0;
+		int base = w * 64;
+		int end = min(n - base, 64);
+		int j = 0;
+		for ( ; j + 4 <= end; j += 4 ) {
+			__m256i ts = _mm256_loadu_si256((const __m256i *)(timestamps + base + j));
+			__m256i age = _mm256_sub_epi64(vnow, ts);
+			s |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(age, vfail))) << j;
+			e |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(age, vremove))) << j;
+		}
+		for ( ; j < end; j++ ) {
+			long age = now - timestamps[base + j];
+			s |= (uint64_t)(age > tfail) << j;
+			e |= (uint64_t)(age > tremove) << j;
+		}
+		suspected[w] = s;
+		expired[w] = e;
+	}
+}
+
+#else
+
+void ExpirySweep::sse2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	scalar(timestamps, n, now, tfail, tremove, suspected, expired);
+}
+
+void ExpirySweep::avx2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	scalar(timestamps, n, now, tfail, tremove, suspected, expired);
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**********************************
+ * FILE NAME: Sweep.h
+ *
+ * DESCRIPTION: Header file of the membership expiry sweep kernels
+ **********************************/
+
+#ifndef _SWEEP_H_
+#define _SWEEP_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Macros
+ */
+// number of 64 bit words holding one bit per member
+#define SWEEP_WORDS(n) (((n) + 63) / 64)
+
+typedef void (*SweepFn)(const long *, int, long, long, long, uint64_t *, uint64_t *);
+
+/**
+ * CLASS NAME: ExpirySweep
+ *
+ * DESCRIPTION: Computes now - timestamp for a whole timestamp column in one
+ * 				pass and returns two bitmasks: bit i of suspected is set when
+ * 				member i is older than tfail, bit i of expired when it is older
+ * 				than tremove. Both masks hold SWEEP_WORDS(n) words.
+ *
+ * 				run() uses the widest kernel the CPU supports (AVX2, SSE2 or
+ * 				scalar), picked once at the first call. The pick runs under
+ * 				call_once, so the first calls may come from several threads.
+ */
+class ExpirySweep {
+private:
+	static SweepFn impl;
+	static const char *implName;
+	static once_flag selected;
+	static void select();
+public:
+	static void run(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired);
+	static const char *name();
+	static void scalar(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired);
+	static void sse2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired);
+	static void avx2(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired);
+	static bool hasSSE2();
+	static bool hasAVX2();
+	static bool test(const uint64_t *mask, int i) {
+		return (mask[i >> 6] >> (i & 63)) & 1;
+	}
+	// Number of bits set among the first n
+	static int count(const uint64_t *mask, int n) {
+		int bits = 0;
+		for ( int w = 0; w < (n >> 6); w++ ) {
+			bits += __builtin_popcountll(mask[w]);
+		}
+		if ( n & 63 ) {
+			bits += __builtin_popcountll(mask[n >> 6] & ((1ULL << (n & 63)) - 1));
+		}
+		return bits;
+	}
+	// Copy bit from into bit to and clear bit from (for swap and pop removal)
+	static void move(uint64_t *mask, int from, int to) {
+		uint64_t bit = (mask[from >> 6] >> (from & 63)) & 1;
+		mask[to >> 6] = (mask[to >> 6] & ~(1ULL << (to & 63))) | (bit << (to & 63));
+		mask[from >> 6] &= ~(1ULL << (from & 63));
+	}
+};
+
+#endif /* _SWEEP_H_ */
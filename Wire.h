@@ -0,0 +1,106 @@
+/**********************************
+ * FILE NAME: Wire.h
+ *
+ * DESCRIPTION: Byte order independent encoding helpers for the membership
+ * 				protocol messages
+ **********************************/
+
+#ifndef _WIRE_H_
+#define _WIRE_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Macros
+ */
+// version byte leading every encoded membership payload
+#define WIRE_VERSION 3
+// largest encodings of a 32 and a 64 bit varint
+#define WIRE_VARINT32_MAX 5
+#define WIRE_VARINT64_MAX 10
+// largest membership list header after the version byte: seq, total, count
+#define WIRE_LIST_HDR_MAX (3 * WIRE_VARINT32_MAX)
+
+/**
+ * CLASS NAME: WireWriter
+ *
+ * DESCRIPTION: Appends LEB128 varints (least significant group first) to a
+ * 				caller provided buffer. Signed values are zigzag encoded so
+ * 				that small negative numbers stay short.
+ */
+class WireWriter {
+public:
+	char *start;
+	char *ptr;
+	WireWriter(char *buf): start(buf), ptr(buf) {}
+	void putByte(uint8_t b) {
+		*ptr++ = (char)b;
+	}
+	void putVarint(uint64_t v) {
+		while ( v >= 0x80 ) {
+			*ptr++ = (char)(v | 0x80);
+			v >>= 7;
+		}
+		*ptr++ = (char)v;
+	}
+	void putSigned(int64_t v) {
+		putVarint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+	}
+	size_t size() {
+		return ptr - start;
+	}
+	static int varintSize(uint64_t v) {
+		int n = 1;
+		while ( v >= 0x80 ) {
+			v >>= 7;
+			n++;
+		}
+		return n;
+	}
+	static int signedSize(int64_t v) {
+		return varintSize(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+	}
+};
+
+/**
+ * CLASS NAME: WireReader
+ *
+ * DESCRIPTION: Reads what WireWriter wrote. Reading past the end of the buffer
+ * 				or an overlong varint clears ok and returns 0.
+ */
+class WireReader {
+public:
+	const char *ptr;
+	const char *end;
+	bool ok;
+	WireReader(const char *buf, size_t size): ptr(buf), end(buf + size), ok(true) {}
+	uint8_t getByte() {
+		if ( ptr >= end ) {
+			ok = false;
+			return 0;
+		}
+		return (uint8_t)*ptr++;
+	}
+	uint64_t getVarint() {
+		uint64_t v = 0;
+		for ( int shift = 0; shift < 64; shift += 7 ) {
+			uint8_t b = getByte();
+			v |= (uint64_t)(b & 0x7f) << shift;
+			if ( !(b & 0x80) ) {
+				return v;
+			}
+		}
+		ok = false;
+		return 0;
+	}
+	int64_t getSigned() {
+		uint64_t v = getVarint();
+		return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+	}
+	bool done() {
+		return ptr >= end;
+	}
+};
+
+#endif /* _WIRE_H_ */
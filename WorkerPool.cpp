@@ -0,0 +1,105 @@
+/**********************************
+ * FILE NAME: WorkerPool.cpp
+ *
+ * DESCRIPTION: Definition of the thread pool running the per node phases
+ * 				of a simulation tick
+ **********************************/
+
+#include "WorkerPool.h"
+
+/**
+ * Constructor. size counts the calling thread.
+ */
+WorkerPool::WorkerPool(int size): count(0), next(0), busy(0), round(0), stopping(false) {
+	for ( int i = 1; i < size; i++ ) {
+		threads.push_back(thread(&WorkerPool::work, this));
+	}
+}
+
+/**
+ * Destructor
+ */
+WorkerPool::~WorkerPool() {
+	{
+		unique_lock<mutex> guard(lock);
+		stopping = true;
+	}
+	started.notify_all();
+	for ( unsigned int i = 0; i < threads.size(); i++ ) {
+		threads[i].join();
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Run job on every item in [0, count) and wait for all of them
+ */
+void WorkerPool::run(int count, const function<void(int)> &job) {
+	if ( threads.empty() ) {
+		for ( int i = 0; i < count; i++ ) {
+			job(i);
+		}
+		return;
+	}
+
+	{
+		unique_lock<mutex> guard(lock);
+		this->job = job;
+		this->count = count;
+		next = 0;
+		busy = threads.size();
+		round++;
+	}
+	started.notify_all();
+
+	drain();
+
+	unique_lock<mutex> guard(lock);
+	while ( busy > 0 ) {
+		finished.wait(guard);
+	}
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Take chunks of items until none is left
+ */
+void WorkerPool::drain() {
+	int first;
+	while ( (first = next.fetch_add(WORKER_CHUNK)) < count ) {
+		int last = min(first + WORKER_CHUNK, count);
+		for ( int i = first; i < last; i++ ) {
+			job(i);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: work
+ *
+ * DESCRIPTION: Main loop of a helper thread
+ */
+void WorkerPool::work() {
+	long seen = 0;
+	while ( true ) {
+		{
+			unique_lock<mutex> guard(lock);
+			while ( !stopping && round == seen ) {
+				started.wait(guard);
+			}
+			if ( stopping ) {
+				return;
+			}
+			seen = round;
+		}
+
+		drain();
+
+		unique_lock<mutex> guard(lock);
+		if ( --busy == 0 ) {
+			finished.notify_one();
+		}
+	}
+}
@@ -0,0 +1,52 @@
+/**********************************
+ * FILE NAME: WorkerPool.h
+ *
+ * DESCRIPTION: Header file of the thread pool running the per node phases
+ * 				of a simulation tick
+ **********************************/
+
+#ifndef _WORKERPOOL_H_
+#define _WORKERPOOL_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// number of consecutive items a thread takes at a time
+#define WORKER_CHUNK 16
+
+/**
+ * CLASS NAME: WorkerPool
+ *
+ * DESCRIPTION: Fixed set of threads that run job(0) .. job(count - 1) in
+ * 				parallel. run() returns once every item is done, so two
+ * 				consecutive calls are separated by a barrier. The calling
+ * 				thread works too; a pool of one thread runs everything
+ * 				inline.
+ */
+class WorkerPool {
+private:
+	vector<thread> threads;
+	mutex lock;
+	condition_variable started;
+	condition_variable finished;
+	function<void(int)> job;
+	int count;
+	atomic<int> next;
+	// helper threads still working on the current round
+	int busy;
+	long round;
+	bool stopping;
+	void work();
+	void drain();
+public:
+	WorkerPool(int size);
+	virtual ~WorkerPool();
+	int size() {
+		return threads.size() + 1;
+	}
+	void run(int count, const function<void(int)> &job);
+};
+
+#endif /* _WORKERPOOL_H_ */
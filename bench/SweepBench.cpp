@@ -0,0 +1,95 @@
+/**********************************
+ * FILE NAME: SweepBench.cpp
+ *
+ * DESCRIPTION: Microbenchmark of the membership expiry sweep. Compares the
+ * 				per-member loops MP1Node used before (a TREMOVE pass and a
+ * 				TFAIL pass) with the ExpirySweep kernels.
+ *
+ * 				Build and run with: make sweepbench && ./sweepbench
+ **********************************/
+
+#include "Sweep.h"
+#include <sys/time.h>
+
+#define TFAIL 5
+#define TREMOVE 20
+#define NOW 1000
+
+static double nowUsec() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+/*
+ * The two branchy loops of nodeLoopOps / serializeList, reduced to their
+ * decisions
+ */
+static void legacy(const long *timestamps, int n, long now, long tfail, long tremove, uint64_t *suspected, uint64_t *expired) {
+	memset(suspected, 0, SWEEP_WORDS(n) * sizeof(uint64_t));
+	memset(expired, 0, SWEEP_WORDS(n) * sizeof(uint64_t));
+	for ( int i = 0; i < n; i++ ) {
+		if ( now - timestamps[i] > tremove ) {
+			expired[i >> 6] |= 1ULL << (i & 63);
+		}
+	}
+	for ( int i = 0; i < n; i++ ) {
+		if ( now - timestamps[i] > tfail ) {
+			suspected[i >> 6] |= 1ULL << (i & 63);
+		}
+	}
+}
+
+/*
+ * Average nanoseconds per sweep of n members
+ */
+static double timeKernel(SweepFn fn, const long *timestamps, int n, uint64_t *s, uint64_t *e) {
+	int reps = max(1, 20000000 / n);
+	double start = nowUsec();
+	for ( int r = 0; r < reps; r++ ) {
+		fn(timestamps, n, NOW + (r & 1), TFAIL, TREMOVE, s, e);
+	}
+	return (nowUsec() - start) * 1000.0 / reps;
+}
+
+int main() {
+	int sizes[] = { 10, 100, 1000, 10000 };
+	const char *names[] = { "legacy", "scalar", "sse2", "avx2" };
+	SweepFn fns[] = { legacy, ExpirySweep::scalar, ExpirySweep::sse2, ExpirySweep::avx2 };
+	bool usable[] = { true, true, ExpirySweep::hasSSE2(), ExpirySweep::hasAVX2() };
+
+	srand(1);
+	printf("dispatch: %s\n", ExpirySweep::name());
+	printf("%8s", "members");
+	for ( int k = 0; k < 4; k++ ) {
+		printf(" %10s", names[k]);
+	}
+	printf("   (ns per sweep)\n");
+
+	for ( int si = 0; si < 4; si++ ) {
+		int n = sizes[si];
+		vector<long> timestamps(n);
+		for ( int i = 0; i < n; i++ ) {
+			// Mostly fresh members, a few suspected or expired ones
+			timestamps[i] = NOW - (rand() % 10 == 0 ? rand() % 40 : rand() % TFAIL);
+		}
+		vector<uint64_t> s0(SWEEP_WORDS(n)), e0(SWEEP_WORDS(n)), s(SWEEP_WORDS(n)), e(SWEEP_WORDS(n));
+		legacy(&timestamps[0], n, NOW, TFAIL, TREMOVE, &s0[0], &e0[0]);
+
+		printf("%8d", n);
+		for ( int k = 0; k < 4; k++ ) {
+			if ( !usable[k] ) {
+				printf(" %10s", "n/a");
+				continue;
+			}
+			fns[k](&timestamps[0], n, NOW, TFAIL, TREMOVE, &s[0], &e[0]);
+			if ( s != s0 || e != e0 ) {
+				printf("\n%s disagrees with the legacy loop at %d members\n", names[k], n);
+				return 1;
+			}
+			printf(" %10.1f", timeKernel(fns[k], &timestamps[0], n, &s[0], &e[0]));
+		}
+		printf("\n");
+	}
+	return 0;
+}
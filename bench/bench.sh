@@ -0,0 +1,89 @@
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/bench.sh
+#* About this file: Scaling benchmark driver.
+#*
+#* Runs the simulator over every combination of group size, message drop
+#* probability and failure pattern, and appends the metrics of each run
+#* (see Metrics.h) to bench_results.csv, one row per run, and to
+#* bench_results.jsonl, one JSON object per run.
+#*
+#* usage: bench/bench.sh [Application binary]      (make bench)
+#*
+#* Settings, from the environment:
+#*   BENCH_SIZES     group sizes                  "10 100 1000"
+#*   BENCH_DROPS     drop probabilities           "0 0.1"
+#*   BENCH_PATTERNS  single, multi, partition or none
+#*                                                "single multi partition"
+#*   BENCH_SEED      SEED of every run            1
+#*   BENCH_EXTRA     more "KEY: value" settings for every run, separated
+#*                   by ';', e.g. "PROTOCOL: 1; THREADS: 4"
+#*   BENCH_OUT       prefix of the result files   bench_results
+#*
+#* Every run lasts 700 ticks: the nodes join by t=250, messages are
+#* dropped from t=300 to t=600, and the failure pattern hits at t=400.
+#* 10000 nodes take about half a second a tick, so the six runs of a size
+#* take most of an hour; they are left out of the defaults, set
+#* BENCH_SIZES=10000 to run them.
+#***********************
+#!/bin/bash
+
+app=${1:-./Application-bench}
+if [ ! -x "$app" ]; then
+	echo "$app: no such program, run make bench" >&2
+	exit 1
+fi
+app=$(cd "$(dirname "$app")" && pwd)/$(basename "$app")
+
+sizes=${BENCH_SIZES:-"10 100 1000"}
+drops=${BENCH_DROPS:-"0 0.1"}
+patterns=${BENCH_PATTERNS:-"single multi partition"}
+seed=${BENCH_SEED:-1}
+out=${BENCH_OUT:-bench_results}
+
+run=$(mktemp -d)
+trap 'rm -rf "$run"' EXIT
+rm -f "$out.csv" "$out.jsonl"
+
+for n in $sizes; do
+	# Join everyone by t=250 whatever the size
+	step=$(awk -v n=$n 'BEGIN { s = 250 / n; print (s > 0.25 ? 0.25 : s) }')
+	for p in $drops; do
+		for pattern in $patterns; do
+			{
+				echo "MAX_NNB: $n"
+				echo "STEP_RATE: $step"
+				echo "SEED: $seed"
+				echo "RUN_LENGTH: 700"
+				if [ "$p" != "0" ]; then
+					echo "EVENT: 300 drop $p"
+					echo "EVENT: 600 drop 0"
+				fi
+				case $pattern in
+					single) echo "EVENT: 400 fail random 1" ;;
+					multi) echo "EVENT: 400 fail random $((n / 2))" ;;
+					partition) echo "EVENT: 400 partition 0-$((n / 2 - 1)) for 50" ;;
+					none) ;;
+					*) echo "unknown failure pattern $pattern" >&2; exit 1 ;;
+				esac
+				echo "$BENCH_EXTRA" | tr ';' '\n' | sed 's/^ *//'
+			} > "$run/bench.conf" || exit 1
+
+			if ! (cd "$run" && "$app" bench.conf > /dev/null); then
+				echo "size $n drop $p $pattern: run failed" >&2
+				continue
+			fi
+
+			# The scalar metrics, without the per failure rows
+			if [ ! -f "$out.csv" ]; then
+				awk -F, 'BEGIN { printf "size,drop,pattern" } NR > 1 && $1 !~ /^failure\./ { printf ",%s", $1 } END { print "" }' "$run/metrics.csv" > "$out.csv"
+			fi
+			awk -F, -v n=$n -v p=$p -v f=$pattern 'BEGIN { printf "%s,%s,%s", n, p, f } NR > 1 && $1 !~ /^failure\./ { printf ",%s", $2 } END { print "" }' "$run/metrics.csv" >> "$out.csv"
+			printf '{"size": %s, "drop": %s, "pattern": "%s", "metrics": %s}\n' $n $p $pattern "$(tr -d '\n' < "$run/metrics.json")" >> "$out.jsonl"
+
+			echo "size $n drop $p $pattern: $(grep -E '^run\.(wall_ms_per_tick|peak_rss_kb),' "$run/metrics.csv" | tr '\n' ' ')" >&2
+		done
+	done
+done
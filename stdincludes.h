@@ -35,11 +35,15 @@
 #include <algorithm>
 #include <queue>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
 
 using namespace std;
 
 #define STDCLLBKARGS (void *env, char *data, int size)
 #define STDCLLBKRET	void
-#define DEBUGLOG 1
 		
 #endif	/* _STDINCLUDES_H_ */
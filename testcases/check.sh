@@ -0,0 +1,80 @@
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: testcases/check.sh
+#* About this file: Protocol property checks.
+#*
+#* Runs the simulator on fixed seeds and checks properties of the run
+#* from its metrics.csv (see Metrics.h) that Grader.sh does not look at:
+#*   - delta gossip removes no live member on a lossless network
+#*   - neither does buffer gossip, and once the group has joined it sends
+#*     no more bytes per node at 400 nodes than at 100
+#*
+#* usage: testcases/check.sh [Application binary]     (make check)
+#*
+#* Prints one line per check and exits 1 if any failed.
+#***********************
+#!/bin/bash
+
+app=${1:-./Application-bench}
+if [ ! -x "$app" ]; then
+	echo "$app: no such program, run make check" >&2
+	exit 1
+fi
+app=$(cd "$(dirname "$app")" && pwd)/$(basename "$app")
+
+run=$(mktemp -d)
+trap 'rm -rf "$run"' EXIT
+failed=0
+
+# Run the settings given as arguments, one "KEY: value" each, in $run
+simulate () {
+	printf '%s\n' "$@" > "$run/check.conf"
+	(cd "$run" && "$app" check.conf > /dev/null)
+}
+
+# Value of metric $1 of the last run
+metric () {
+	awk -F, -v k="$1" '$1 == k { print $2 }' "$run/metrics.csv"
+}
+
+# Bytes sent by all the nodes of the last run, from msgcount.log
+sent_bytes () {
+	awk '$1 == "sent_bytes" && $3 == "over" { print $2 }' "$run/msgcount.log"
+}
+
+# Bytes sent per node and tick from t=400 to t=700 by $1 nodes in buffer
+# mode, without failures: the difference of two runs of the same seed
+steady_bytes () {
+	simulate "MAX_NNB: $1" "SEED: 7" "EVENT: 0 drop 0" "GOSSIP_MODE: 3" "RUN_LENGTH: 400"
+	local before=$(sent_bytes)
+	simulate "MAX_NNB: $1" "SEED: 7" "EVENT: 0 drop 0" "GOSSIP_MODE: 3" "RUN_LENGTH: 700"
+	awk -v a=$before -v b=$(sent_bytes) -v n=$1 'BEGIN { print (b - a) / (300 * n) }'
+}
+
+# Report check $1 as passed if the awk condition $2 holds
+verdict () {
+	if awk "BEGIN { exit !($2) }"; then
+		echo "$1: ok"
+	else
+		echo "$1: FAILED ($2)"
+		failed=1
+	fi
+}
+
+for seed in 4 7; do
+	simulate "MAX_NNB: 100" "SEED: $seed" "SINGLE_FAILURE: 1" "DROP_MSG: 0" "GOSSIP_MODE: 1"
+	verdict "delta gossip, lossless, seed $seed: no false removal" "$(metric false_removals) == 0"
+done
+
+for n in 100 400; do
+	simulate "MAX_NNB: $n" "SEED: 7" "SINGLE_FAILURE: 1" "DROP_MSG: 0" "GOSSIP_MODE: 3"
+	verdict "buffer gossip, lossless, $n nodes: no false removal" "$(metric false_removals) == 0"
+done
+
+small=$(steady_bytes 100)
+large=$(steady_bytes 400)
+verdict "buffer gossip: bytes per node and tick bounded as the group grows" "$large <= 1.25 * $small"
+
+exit $failed